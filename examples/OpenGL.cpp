@@ -259,7 +259,7 @@ void drawCapsule(glm::vec3 start, glm::vec3 end, float radius, glm::vec3 color)
 /* Handler for window-repaint event. Called back when the window first appears and
    whenever the window needs to be re-painted. */
 
-void drawAABB(std::vector<ml::vec3> points, float red, float green, float blue) {
+void drawAABB(const std::array<ml::vec3, 8> &points, float red, float green, float blue) {
   glBegin(GL_QUADS);            // Begin drawing the color cube with 6 quads
   glColor3f(red, green, blue);  // Green
                                 //
@@ -0,0 +1,162 @@
+#include <cfloat>
+#include <stdexcept>
+
+#include "BodyStorage.hpp"
+
+namespace {
+  // the columns of the rotation part of a transform are the axes of the body scaled, their lengths give the scale.
+  // Throw std::invalid_argument when an axis is null or when the transform mirrors the body, no rotation gives them
+  auto decompose(const ml::mat4 &matrix, ml::vec3 &scale) -> Quaternion {
+    Matrix<float, 3, 3> rotation{matrix.getRotation()};
+    float               determinant{rotation[0][0] * (rotation[1][1] * rotation[2][2] - rotation[2][1] * rotation[1][2]) - rotation[1][0] * (rotation[0][1] * rotation[2][2] - rotation[2][1] * rotation[0][2]) + rotation[2][0] * (rotation[0][1] * rotation[1][2] - rotation[1][1] * rotation[0][2])};
+    if (determinant < 0.0f)
+      throw std::invalid_argument{"the transform of a body can't mirror it"};
+    ml::vec3 lengths{1.0f, 1.0f, 1.0f};
+    for (std::uint32_t column{0}; column < 3; ++column) {
+      lengths[column] = std::sqrt(rotation[column][0] * rotation[column][0] + rotation[column][1] * rotation[column][1] + rotation[column][2] * rotation[column][2]);
+      if (!(lengths[column] > FLT_EPSILON))  // NaN too
+        throw std::invalid_argument{"the transform of a body can't have a null scale"};
+      for (std::uint32_t row{0}; row < 3; ++row)
+        rotation[column][row] /= lengths[column];
+    }
+    scale = lengths;
+    Quaternion orientation{Quaternion::fromMatrix(rotation)};
+    orientation.normalize();
+    return orientation;
+  }
+}
+
+auto BodyStorage::create(PhysicsObject &&object, const Transform &transform) -> BodyHandle {
+  ml::vec3   scale{1.0f, 1.0f, 1.0f};
+  Quaternion orientation{decompose(transform.matrix, scale)};  // before anything is added, it can throw
+
+  BodyHandle handle{static_cast<BodyHandle>(m_indices.size())};
+  if (!m_freeHandles.empty()) {
+    handle = m_freeHandles.back();
+    m_freeHandles.pop_back();
+  } else {
+    m_indices.push_back(0);
+  }
+  m_indices[handle] = m_handles.size();
+  m_handles.push_back(handle);
+
+  positions.push_back(transform.matrix.getTranslation());
+  orientations.push_back(orientation);
+  linearVelocities.push_back(object.getLinearVelocity());
+  angularVelocities.push_back(object.getAngularVelocity());
+  forces.push_back(object.getForce());
+  torques.push_back(object.getTorque());
+  inverseMasses.push_back(object.getInverseMass());
+  inverseInertias.push_back(object.getInverseInertia());
+  inverseInertiaTensors.push_back(object.getInertiaTensor());
+  elasticities.push_back(object.getElasticity());
+  frictions.push_back(object.getFriction());
+  rigids.push_back(object.getIsRigid());
+  continuous.push_back(object.getIsContinuous());
+  awakes.push_back(1);
+  sleepTimes.push_back(0.0f);
+  transforms.push_back(transform);
+  scales.push_back(scale);
+  shapes.push_back(std::move(object.m_shape));
+
+  updateWorldState(m_handles.size() - 1);
+  return handle;
+}
+
+void BodyStorage::destroy(BodyHandle handle) {
+  std::size_t index{indexOf(handle)};
+  std::size_t last{m_handles.size() - 1};
+
+  if (index != last) {
+    positions[index]             = positions[last];
+    orientations[index]          = orientations[last];
+    linearVelocities[index]      = linearVelocities[last];
+    angularVelocities[index]     = angularVelocities[last];
+    forces[index]                = forces[last];
+    torques[index]               = torques[last];
+    inverseMasses[index]         = inverseMasses[last];
+    inverseInertias[index]       = inverseInertias[last];
+    inverseInertiaTensors[index] = inverseInertiaTensors[last];
+    elasticities[index]          = elasticities[last];
+    frictions[index]             = frictions[last];
+    rigids[index]                = rigids[last];
+    continuous[index]            = continuous[last];
+    awakes[index]                = awakes[last];
+    sleepTimes[index]            = sleepTimes[last];
+    transforms[index]            = transforms[last];
+    scales[index]                = scales[last];
+    shapes[index]                = std::move(shapes[last]);
+
+    m_handles[index]            = m_handles[last];
+    m_indices[m_handles[index]] = index;
+  }
+
+  positions.pop_back();
+  orientations.pop_back();
+  linearVelocities.pop_back();
+  angularVelocities.pop_back();
+  forces.pop_back();
+  torques.pop_back();
+  inverseMasses.pop_back();
+  inverseInertias.pop_back();
+  inverseInertiaTensors.pop_back();
+  elasticities.pop_back();
+  frictions.pop_back();
+  rigids.pop_back();
+  continuous.pop_back();
+  awakes.pop_back();
+  sleepTimes.pop_back();
+  transforms.pop_back();
+  scales.pop_back();
+  shapes.pop_back();
+  m_handles.pop_back();
+
+  m_indices[handle] = SIZE_MAX;
+  m_freeHandles.push_back(handle);
+}
+
+bool BodyStorage::contains(BodyHandle handle) const noexcept {
+  return handle >= 0 && static_cast<std::size_t>(handle) < m_indices.size() && m_indices[handle] != SIZE_MAX;
+}
+
+auto BodyStorage::indexOf(BodyHandle handle) const -> std::size_t {
+  if (!contains(handle))
+    throw std::out_of_range{"invalid body handle " + std::to_string(handle)};
+  return m_indices[handle];
+}
+
+auto BodyStorage::handleOf(std::size_t index) const noexcept -> BodyHandle {
+  return m_handles[index];
+}
+
+auto BodyStorage::size() const noexcept -> std::size_t {
+  return m_handles.size();
+}
+
+void BodyStorage::setTransform(std::size_t index, const Transform &transform) {
+  orientations[index] = decompose(transform.matrix, scales[index]);
+  positions[index]    = transform.matrix.getTranslation();
+  updateWorldState(index);
+}
+
+void BodyStorage::updateWorldState(std::size_t index) {
+  // the only conversion of the orientation, the integration works on the quaternion
+  const Matrix<float, 3, 3> orientation{orientations[index].toMatrix3()};
+  const ml::vec3 &          inverseInertia{inverseInertias[index]};
+  const ml::vec3 &          scale{scales[index]};
+
+  ml::mat4 &matrix{transforms[index].matrix};
+  for (std::uint32_t column{0}; column < 3; ++column) {
+    for (std::uint32_t row{0}; row < 3; ++row)
+      matrix[column][row] = orientation[column][row] * scale[column];
+  }
+  matrix.setTranslation(positions[index]);
+
+  // inverseInertiaTensor = R * diag(inverseInertia) * transpose(R), matrices are stored [column][row]
+  Matrix<float, 3, 3> &tensor{inverseInertiaTensors[index]};
+  for (std::uint32_t column{0}; column < 3; ++column) {
+    for (std::uint32_t row{0}; row < 3; ++row) {
+      tensor[column][row] = orientation[0][row] * inverseInertia[0] * orientation[0][column] + orientation[1][row] * inverseInertia[1] * orientation[1][column] + orientation[2][row] * inverseInertia[2] * orientation[2][column];
+    }
+  }
+}
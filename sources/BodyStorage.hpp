@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Transform.hpp"
+#include "PhysicsObject.hpp"
+#include "CollisionShape.hpp"
+
+#include "Maths/Math.hpp"
+#include "Maths/Quaternion.hpp"
+#include "Library.hpp"
+
+using BodyHandle = int;
+
+inline constexpr BodyHandle INVALID_BODY{-1};
+
+// Structure-of-arrays storage for every body simulated by the PhysicsSystem.
+// All the arrays below are dense and share the same index: body `i` is made of
+// positions[i], orientations[i], linearVelocities[i]...
+// Removing a body moves the last one in its slot, so dense indices are not stable:
+// keep a BodyHandle and go through indexOf() to find a body again.
+class BodyStorage final {
+public:
+  std::vector<ml::vec3>            positions{};
+  std::vector<Quaternion>          orientations{};  // unit length, integrated as is
+  std::vector<ml::vec3>            linearVelocities{};
+  std::vector<ml::vec3>            angularVelocities{};
+  std::vector<ml::vec3>            forces{};
+  std::vector<ml::vec3>            torques{};
+  std::vector<float>               inverseMasses{};
+  std::vector<ml::vec3>            inverseInertias{};        // local space, diagonal of the inverse inertia tensor
+  std::vector<Matrix<float, 3, 3>> inverseInertiaTensors{};  // world space, rebuilt from the orientation
+  std::vector<float>               elasticities{};
+  std::vector<float>               frictions{};
+  std::vector<std::uint8_t>        rigids{};
+  std::vector<std::uint8_t>        continuous{};  // swept against the other bodies when it moves fast enough to go through them
+  std::vector<std::uint8_t>        awakes{};      // a sleeping body is neither integrated nor moved in the broadphase
+  std::vector<float>               sleepTimes{};  // how long the body has been slower than the sleep tolerances
+
+  // cold data, only touched by the narrowphase and the user
+  std::vector<Transform>      transforms{};  // world matrices rebuilt from positions / orientations / scales
+  std::vector<ml::vec3>       scales{};      // of the transform given by the user, only applied to the world matrix
+  std::vector<CollisionShape> shapes{};      // stored by value, no allocation per body
+
+public:
+  DLLATTRIB explicit BodyStorage() = default;
+
+  [[nodiscard]] DLLATTRIB auto create(PhysicsObject &&object, const Transform &transform) -> BodyHandle;  // throw std::invalid_argument on a null scale or a mirroring transform
+  DLLATTRIB void               destroy(BodyHandle handle);
+
+  [[nodiscard]] DLLATTRIB bool contains(BodyHandle handle) const noexcept;
+  [[nodiscard]] DLLATTRIB auto indexOf(BodyHandle handle) const -> std::size_t;  // throw std::out_of_range on a dead handle
+  [[nodiscard]] DLLATTRIB auto handleOf(std::size_t index) const noexcept -> BodyHandle;
+  [[nodiscard]] DLLATTRIB auto size() const noexcept -> std::size_t;
+
+  DLLATTRIB void setTransform(std::size_t index, const Transform &transform);  // throw std::invalid_argument like create, the body is unchanged
+  DLLATTRIB void updateWorldState(std::size_t index);  // Called after positions / orientations changed
+
+private:
+  std::vector<BodyHandle>  m_handles{};  // dense index -> handle
+  std::vector<std::size_t> m_indices{};  // handle -> dense index
+  std::vector<BodyHandle>  m_freeHandles{};
+};
@@ -0,0 +1,6 @@
+#pragma once
+
+enum class BroadphaseType {
+    SWEEP_AND_PRUNE,
+    DYNAMIC_TREE
+};
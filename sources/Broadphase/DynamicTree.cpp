@@ -0,0 +1,372 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "DynamicTree.hpp"
+
+auto DynamicTree::allocateNode() -> int {
+  if (m_freeList == NULL_NODE) {
+    m_nodes.emplace_back();
+    m_nodes.back().height = 0;
+    return static_cast<int>(m_nodes.size() - 1);
+  }
+  int node{m_freeList};
+  m_freeList          = m_nodes[node].parent;
+  m_nodes[node]       = Node{};
+  m_nodes[node].height = 0;
+  return node;
+}
+
+void DynamicTree::freeNode(int node) {
+  m_nodes[node].parent = m_freeList;
+  m_nodes[node].height = -1;
+  m_freeList           = node;
+}
+
+void DynamicTree::insert(BodyHandle handle, const Bounds &bounds, bool isStatic) {
+  if (static_cast<std::size_t>(handle) >= m_leaves.size()) {
+    m_leaves.resize(handle + 1, NULL_NODE);
+    m_tightBounds.resize(handle + 1);
+  }
+
+  int leaf{allocateNode()};
+  m_nodes[leaf].bounds   = bounds.expand(FAT_MARGIN);
+  m_nodes[leaf].handle   = handle;
+  m_nodes[leaf].isStatic = isStatic;
+  m_leaves[handle]       = leaf;
+  m_tightBounds[handle]  = bounds;
+  insertLeaf(leaf);
+}
+
+void DynamicTree::remove(BodyHandle handle) {
+  int leaf{m_leaves[handle]};
+  removeLeaf(leaf);
+  freeNode(leaf);
+  m_leaves[handle] = NULL_NODE;
+}
+
+bool DynamicTree::move(BodyHandle handle, const Bounds &bounds, const ml::vec3 &displacement) {
+  int leaf{m_leaves[handle]};
+  m_tightBounds[handle] = bounds;
+  if (m_nodes[leaf].bounds.contains(bounds))
+    return false;
+
+  // predict the motion so a body moving at constant speed isn't reinserted every frame
+  Bounds   fat{bounds.expand(FAT_MARGIN)};
+  ml::vec3 predicted{displacement * DISPLACEMENT_MULTIPLIER};
+  for (std::uint32_t axis{0}; axis < 3; ++axis) {
+    if (predicted[axis] < 0.0f)
+      fat.min[axis] += predicted[axis];
+    else
+      fat.max[axis] += predicted[axis];
+  }
+
+  removeLeaf(leaf);
+  m_nodes[leaf].bounds = fat;
+  insertLeaf(leaf);
+  return true;
+}
+
+void DynamicTree::setStatic(BodyHandle handle, bool isStatic) {
+  m_nodes[m_leaves[handle]].isStatic = isStatic;
+}
+
+bool DynamicTree::contains(BodyHandle handle) const noexcept {
+  return handle >= 0 && static_cast<std::size_t>(handle) < m_leaves.size() && m_leaves[handle] != NULL_NODE;
+}
+
+auto DynamicTree::getBounds(BodyHandle handle) const -> const Bounds & {
+  if (!contains(handle))
+    throw std::out_of_range{"body " + std::to_string(handle) + " is not in the tree"};
+  return m_tightBounds[handle];
+}
+
+auto DynamicTree::getFatBounds(BodyHandle handle) const -> const Bounds & {
+  if (!contains(handle))
+    throw std::out_of_range{"body " + std::to_string(handle) + " is not in the tree"};
+  return m_nodes[m_leaves[handle]].bounds;
+}
+
+auto DynamicTree::getHeight() const noexcept -> int {
+  return m_root == NULL_NODE ? 0 : m_nodes[m_root].height;
+}
+
+float DynamicTree::area(const Bounds &bounds) noexcept {
+  ml::vec3 size{bounds.max - bounds.min};
+  return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+bool DynamicTree::intersects(const Ray &ray, const ml::vec3 &inverseDirection, const Bounds &bounds, float maxDistance) noexcept {
+  ml::vec3 origin{ray.GetPosition()};
+  float    tMin{0.0f};
+  float    tMax{maxDistance};
+  for (std::uint32_t axis{0}; axis < 3; ++axis) {
+    float t1{(bounds.min[axis] - origin[axis]) * inverseDirection[axis]};
+    float t2{(bounds.max[axis] - origin[axis]) * inverseDirection[axis]};
+    // NaN (origin on the slab with a null direction) never shrink the interval
+    tMin = std::max(tMin, std::min(t1, t2));
+    tMax = std::min(tMax, std::max(t1, t2));
+  }
+  return tMin <= tMax;
+}
+
+auto DynamicTree::intersects(const RayPacket &packet, const Bounds &bounds) noexcept -> std::uint32_t {
+#if ML_SIMD_SSE
+  using ml::simd::float4;
+  float4 tMin{ml::simd::zero()};
+  float4 tMax{ml::simd::load4(packet.maxDistances.data())};
+  for (std::uint32_t axis{0}; axis < 3; ++axis) {
+    float4 origin{ml::simd::load4(packet.origins[axis].data())};
+    float4 inverseDirection{ml::simd::load4(packet.inverseDirections[axis].data())};
+    float4 t1{ml::simd::mul(ml::simd::sub(ml::simd::splat(bounds.min[axis]), origin), inverseDirection)};
+    float4 t2{ml::simd::mul(ml::simd::sub(ml::simd::splat(bounds.max[axis]), origin), inverseDirection)};
+    tMin = ml::simd::max(tMin, ml::simd::min(t1, t2));
+    tMax = ml::simd::min(tMax, ml::simd::max(t1, t2));
+  }
+  return static_cast<std::uint32_t>(ml::simd::signMask(ml::simd::lessEqual(tMin, tMax))) & packet.activeMask;
+#else
+  std::uint32_t lanes{0};
+  for (std::uint32_t lane{0}; lane < packet.count; ++lane) {
+    float tMin{0.0f};
+    float tMax{packet.maxDistances[lane]};
+    for (std::uint32_t axis{0}; axis < 3; ++axis) {
+      float t1{(bounds.min[axis] - packet.origins[axis][lane]) * packet.inverseDirections[axis][lane]};
+      float t2{(bounds.max[axis] - packet.origins[axis][lane]) * packet.inverseDirections[axis][lane]};
+      tMin = std::max(tMin, std::min(t1, t2));
+      tMax = std::min(tMax, std::max(t1, t2));
+    }
+    if (tMin <= tMax)
+      lanes |= 1u << lane;
+  }
+  return lanes;
+#endif
+}
+
+void DynamicTree::insertLeaf(int leaf) {
+  if (m_root == NULL_NODE) {
+    m_root                 = leaf;
+    m_nodes[leaf].parent   = NULL_NODE;
+    return;
+  }
+
+  // Find the best sibling with the surface area heuristic
+  const Bounds leafBounds{m_nodes[leaf].bounds};
+  int          index{m_root};
+  while (!m_nodes[index].isLeaf()) {
+    const Node &node{m_nodes[index]};
+    float       nodeArea{area(node.bounds)};
+    float       combinedArea{area(node.bounds.merge(leafBounds))};
+
+    // cost of creating a new parent for this node and the new leaf
+    float cost{2.0f * combinedArea};
+    // minimum cost of pushing the leaf further down the tree
+    float inheritanceCost{2.0f * (combinedArea - nodeArea)};
+
+    auto descendCost = [&](int child) {
+      float mergedArea{area(m_nodes[child].bounds.merge(leafBounds))};
+      if (m_nodes[child].isLeaf())
+        return mergedArea + inheritanceCost;
+      return mergedArea - area(m_nodes[child].bounds) + inheritanceCost;
+    };
+    float cost1{descendCost(node.child1)};
+    float cost2{descendCost(node.child2)};
+
+    if (cost < cost1 && cost < cost2)
+      break;
+    index = cost1 < cost2 ? node.child1 : node.child2;
+  }
+
+  int sibling{index};
+  int oldParent{m_nodes[sibling].parent};
+  int newParent{allocateNode()};
+  m_nodes[newParent].parent = oldParent;
+  m_nodes[newParent].bounds = leafBounds.merge(m_nodes[sibling].bounds);
+  m_nodes[newParent].height = m_nodes[sibling].height + 1;
+  m_nodes[newParent].child1 = sibling;
+  m_nodes[newParent].child2 = leaf;
+  m_nodes[sibling].parent   = newParent;
+  m_nodes[leaf].parent      = newParent;
+
+  if (oldParent == NULL_NODE) {
+    m_root = newParent;
+  } else if (m_nodes[oldParent].child1 == sibling) {
+    m_nodes[oldParent].child1 = newParent;
+  } else {
+    m_nodes[oldParent].child2 = newParent;
+  }
+
+  // Walk back up the tree fixing heights and bounds
+  index = m_nodes[leaf].parent;
+  while (index != NULL_NODE) {
+    index = balance(index);
+
+    int child1{m_nodes[index].child1};
+    int child2{m_nodes[index].child2};
+    m_nodes[index].height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+    m_nodes[index].bounds = m_nodes[child1].bounds.merge(m_nodes[child2].bounds);
+
+    index = m_nodes[index].parent;
+  }
+}
+
+void DynamicTree::removeLeaf(int leaf) {
+  if (leaf == m_root) {
+    m_root = NULL_NODE;
+    return;
+  }
+
+  int parent{m_nodes[leaf].parent};
+  int grandParent{m_nodes[parent].parent};
+  int sibling{m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1};
+
+  if (grandParent == NULL_NODE) {
+    m_root                  = sibling;
+    m_nodes[sibling].parent = NULL_NODE;
+    freeNode(parent);
+    return;
+  }
+
+  // Destroy parent and connect sibling to grandParent
+  if (m_nodes[grandParent].child1 == parent)
+    m_nodes[grandParent].child1 = sibling;
+  else
+    m_nodes[grandParent].child2 = sibling;
+  m_nodes[sibling].parent = grandParent;
+  freeNode(parent);
+
+  int index{grandParent};
+  while (index != NULL_NODE) {
+    index = balance(index);
+
+    int child1{m_nodes[index].child1};
+    int child2{m_nodes[index].child2};
+    m_nodes[index].bounds = m_nodes[child1].bounds.merge(m_nodes[child2].bounds);
+    m_nodes[index].height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+
+    index = m_nodes[index].parent;
+  }
+}
+
+// Perform a left or right rotation if node A is imbalanced, return the new root of the subtree
+auto DynamicTree::balance(int iA) -> int {
+  Node &A{m_nodes[iA]};
+  if (A.isLeaf() || A.height < 2)
+    return iA;
+
+  int   iB{A.child1};
+  int   iC{A.child2};
+  Node &B{m_nodes[iB]};
+  Node &C{m_nodes[iC]};
+
+  int heightDifference{C.height - B.height};
+
+  // Rotate C up
+  if (heightDifference > 1) {
+    int   iF{C.child1};
+    int   iG{C.child2};
+    Node &F{m_nodes[iF]};
+    Node &G{m_nodes[iG]};
+
+    // Swap A and C
+    C.child1 = iA;
+    C.parent = A.parent;
+    A.parent = iC;
+
+    // A's old parent should point to C
+    if (C.parent != NULL_NODE) {
+      if (m_nodes[C.parent].child1 == iA)
+        m_nodes[C.parent].child1 = iC;
+      else
+        m_nodes[C.parent].child2 = iC;
+    } else {
+      m_root = iC;
+    }
+
+    // Rotate
+    if (F.height > G.height) {
+      C.child2 = iF;
+      A.child2 = iG;
+      G.parent = iA;
+      A.bounds = B.bounds.merge(G.bounds);
+      C.bounds = A.bounds.merge(F.bounds);
+      A.height = 1 + std::max(B.height, G.height);
+      C.height = 1 + std::max(A.height, F.height);
+    } else {
+      C.child2 = iG;
+      A.child2 = iF;
+      F.parent = iA;
+      A.bounds = B.bounds.merge(F.bounds);
+      C.bounds = A.bounds.merge(G.bounds);
+      A.height = 1 + std::max(B.height, F.height);
+      C.height = 1 + std::max(A.height, G.height);
+    }
+    return iC;
+  }
+
+  // Rotate B up
+  if (heightDifference < -1) {
+    int   iD{B.child1};
+    int   iE{B.child2};
+    Node &D{m_nodes[iD]};
+    Node &E{m_nodes[iE]};
+
+    // Swap A and B
+    B.child1 = iA;
+    B.parent = A.parent;
+    A.parent = iB;
+
+    // A's old parent should point to B
+    if (B.parent != NULL_NODE) {
+      if (m_nodes[B.parent].child1 == iA)
+        m_nodes[B.parent].child1 = iB;
+      else
+        m_nodes[B.parent].child2 = iB;
+    } else {
+      m_root = iB;
+    }
+
+    // Rotate
+    if (D.height > E.height) {
+      B.child2 = iD;
+      A.child1 = iE;
+      E.parent = iA;
+      A.bounds = C.bounds.merge(E.bounds);
+      B.bounds = A.bounds.merge(D.bounds);
+      A.height = 1 + std::max(C.height, E.height);
+      B.height = 1 + std::max(A.height, D.height);
+    } else {
+      B.child2 = iE;
+      A.child1 = iD;
+      D.parent = iA;
+      A.bounds = C.bounds.merge(D.bounds);
+      B.bounds = A.bounds.merge(E.bounds);
+      A.height = 1 + std::max(C.height, D.height);
+      B.height = 1 + std::max(A.height, E.height);
+    }
+    return iB;
+  }
+
+  return iA;
+}
+
+void DynamicTree::findPairs(std::vector<BroadphasePair> &pairs) const {
+  findPairs(0, m_nodes.size(), pairs);
+}
+
+void DynamicTree::findPairs(std::size_t firstNode, std::size_t lastNode, std::vector<BroadphasePair> &pairs) const {
+  for (std::size_t i{firstNode}; i < lastNode; ++i) {
+    const Node &leaf{m_nodes[i]};
+    if (leaf.height != 0 || leaf.isStatic)
+      continue;
+    query(leaf.bounds, [&](BodyHandle other) {
+      // dynamic / dynamic pairs are reported once, by their smallest handle
+      if (other != leaf.handle && (other > leaf.handle || m_nodes[m_leaves[other]].isStatic))
+        pairs.push_back(BroadphasePair{std::min(leaf.handle, other), std::max(leaf.handle, other)});
+      return true;
+    });
+  }
+}
+
+auto DynamicTree::getNodeCount() const noexcept -> std::size_t {
+  return m_nodes.size();
+}
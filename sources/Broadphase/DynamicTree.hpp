@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+#include "BodyStorage.hpp"
+#include "Broadphase/SweepAndPrune.hpp"
+#include "Shapes/Bounds.hpp"
+#include "Shapes/Frustum.hpp"
+#include "Shapes/Raycasting.hpp"
+
+#include "Library.hpp"
+
+// Incremental bounding volume hierarchy keyed by body handle.
+// Leaves store "fat" bounds: the tight bounds grown by a margin and by the last displacement,
+// a body moving inside its fat bounds doesn't touch the tree.
+// Inserting picks the sibling with the cheapest surface area increase, and the tree is kept balanced with AVL like rotations.
+// Based on the dynamic tree of Box2D : https://github.com/erincatto/box2d/blob/main/src/collision/b2_dynamic_tree.cpp
+class DynamicTree final {
+public:
+  static constexpr int   NULL_NODE{-1};
+  static constexpr float FAT_MARGIN{0.1f};
+  static constexpr float DISPLACEMENT_MULTIPLIER{2.0f};
+
+  DLLATTRIB explicit DynamicTree() = default;
+
+  DLLATTRIB void insert(BodyHandle handle, const Bounds &bounds, bool isStatic);
+  DLLATTRIB void remove(BodyHandle handle);
+  DLLATTRIB bool move(BodyHandle handle, const Bounds &bounds, const ml::vec3 &displacement);  // Return true if the leaf had to be reinserted
+  DLLATTRIB void setStatic(BodyHandle handle, bool isStatic);
+
+  [[nodiscard]] DLLATTRIB bool contains(BodyHandle handle) const noexcept;
+  [[nodiscard]] DLLATTRIB auto getBounds(BodyHandle handle) const -> const Bounds &;  // tight bounds
+  [[nodiscard]] DLLATTRIB auto getFatBounds(BodyHandle handle) const -> const Bounds &;
+  [[nodiscard]] DLLATTRIB auto getHeight() const noexcept -> int;
+
+  // Every overlapping couple of leaves where at least one of the two is not static
+  DLLATTRIB void findPairs(std::vector<BroadphasePair> &pairs) const;
+  // Same for the leaves stored in the nodes [firstNode, lastNode), the ranges can be searched concurrently
+  DLLATTRIB void               findPairs(std::size_t firstNode, std::size_t lastNode, std::vector<BroadphasePair> &pairs) const;
+  [[nodiscard]] DLLATTRIB auto getNodeCount() const noexcept -> std::size_t;
+
+  // callback(BodyHandle) -> bool, return false to stop the query
+  template <typename Callback>
+  void query(const Bounds &bounds, Callback &&callback) const;
+  template <typename Callback>
+  void query(const Frustum &frustum, Callback &&callback) const;  // the leaves whose fat bounds aren't outside a plane
+
+  // callback(BodyHandle) -> float, return the new maximum distance of the ray (a hit) or the current one to keep going
+  template <typename Callback>
+  void raycast(const Ray &ray, float maxDistance, Callback &&callback) const;
+
+  // callback(BodyHandle, std::uint32_t lanes), lanes has a bit for every ray of the packet hitting the leaf.
+  // Shrink packet.maxDistances on a hit, the rest of the traversal skips the nodes further than that
+  template <typename Callback>
+  void raycast(RayPacket &packet, Callback &&callback) const;
+
+private:
+  class Node final {
+  public:
+    Bounds     bounds{};
+    int        parent{NULL_NODE};  // next free node when in the free list
+    int        child1{NULL_NODE};
+    int        child2{NULL_NODE};
+    int        height{-1};  // -1 when free, 0 for a leaf
+    BodyHandle handle{INVALID_BODY};
+    bool       isStatic{false};
+
+    [[nodiscard]] inline bool isLeaf() const noexcept {
+      return child1 == NULL_NODE;
+    }
+  };
+
+  [[nodiscard]] auto allocateNode() -> int;
+  void               freeNode(int node);
+  void               insertLeaf(int leaf);
+  void               removeLeaf(int leaf);
+  [[nodiscard]] auto balance(int node) -> int;
+
+  [[nodiscard]] static float area(const Bounds &bounds) noexcept;
+  [[nodiscard]] static bool  intersects(const Ray &ray, const ml::vec3 &inverseDirection, const Bounds &bounds, float maxDistance) noexcept;
+  [[nodiscard]] static auto  intersects(const RayPacket &packet, const Bounds &bounds) noexcept -> std::uint32_t;  // mask of the lanes hitting bounds
+
+  std::vector<Node>   m_nodes{};
+  int                 m_root{NULL_NODE};
+  int                 m_freeList{NULL_NODE};
+  std::vector<int>    m_leaves{};       // body handle -> leaf node
+  std::vector<Bounds> m_tightBounds{};  // body handle -> tight bounds
+};
+
+template <typename Callback>
+void DynamicTree::query(const Bounds &bounds, Callback &&callback) const {
+  if (m_root == NULL_NODE)
+    return;
+
+  int         stack[256];
+  std::size_t count{0};
+  stack[count++] = m_root;
+  while (count > 0) {
+    const Node &node{m_nodes[stack[--count]]};
+    if (!node.bounds.overlaps(bounds))
+      continue;
+    if (node.isLeaf()) {
+      if (!callback(node.handle))
+        return;
+    } else {
+      stack[count++] = node.child1;
+      stack[count++] = node.child2;
+    }
+  }
+}
+
+template <typename Callback>
+void DynamicTree::query(const Frustum &frustum, Callback &&callback) const {
+  if (m_root == NULL_NODE)
+    return;
+
+  int         stack[256];
+  std::size_t count{0};
+  stack[count++] = m_root;
+  while (count > 0) {
+    const Node &node{m_nodes[stack[--count]]};
+    if (!frustum.overlaps(node.bounds))
+      continue;
+    if (node.isLeaf()) {
+      if (!callback(node.handle))
+        return;
+    } else {
+      stack[count++] = node.child1;
+      stack[count++] = node.child2;
+    }
+  }
+}
+
+template <typename Callback>
+void DynamicTree::raycast(const Ray &ray, float maxDistance, Callback &&callback) const {
+  if (m_root == NULL_NODE)
+    return;
+
+  ml::vec3 direction{ray.GetDirection()};
+  ml::vec3 inverseDirection{1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z};
+
+  int         stack[256];
+  std::size_t count{0};
+  stack[count++] = m_root;
+  while (count > 0) {
+    const Node &node{m_nodes[stack[--count]]};
+    if (!intersects(ray, inverseDirection, node.bounds, maxDistance))
+      continue;
+    if (node.isLeaf()) {
+      maxDistance = callback(node.handle);
+    } else {
+      stack[count++] = node.child1;
+      stack[count++] = node.child2;
+    }
+  }
+}
+
+template <typename Callback>
+void DynamicTree::raycast(RayPacket &packet, Callback &&callback) const {
+  if (m_root == NULL_NODE)
+    return;
+
+  int         stack[256];
+  std::size_t count{0};
+  stack[count++] = m_root;
+  while (count > 0) {
+    const Node &node{m_nodes[stack[--count]]};
+    if (packet.isCulled(node.bounds))
+      continue;
+    std::uint32_t lanes{intersects(packet, node.bounds)};
+    if (lanes == 0)
+      continue;
+    if (node.isLeaf()) {
+      callback(node.handle, lanes);
+    } else {
+      stack[count++] = node.child1;
+      stack[count++] = node.child2;
+    }
+  }
+}
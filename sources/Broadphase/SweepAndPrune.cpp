@@ -0,0 +1,145 @@
+#include <algorithm>
+
+#include "SweepAndPrune.hpp"
+
+void SweepAndPrune::insert(BodyHandle handle, const Bounds &bounds, bool isStatic) {
+  if (static_cast<std::size_t>(handle) >= m_proxies.size())
+    m_proxies.resize(handle + 1);
+
+  Proxy &proxy{m_proxies[handle]};
+  proxy.alive    = true;
+  proxy.isStatic = isStatic;
+  for (std::size_t axis{0}; axis < 3; ++axis) {
+    proxy.min[axis] = bounds.min[axis];
+    proxy.max[axis] = bounds.max[axis];
+
+    // pushed at the end, the next insertion sort moves them to their place
+    proxy.minEndpoint[axis] = static_cast<std::uint32_t>(m_endpoints[axis].size());
+    m_endpoints[axis].push_back(Endpoint{proxy.min[axis], static_cast<std::uint32_t>(handle) << 1});
+    proxy.maxEndpoint[axis] = static_cast<std::uint32_t>(m_endpoints[axis].size());
+    m_endpoints[axis].push_back(Endpoint{proxy.max[axis], (static_cast<std::uint32_t>(handle) << 1) | 1});
+  }
+  ++m_count;
+}
+
+void SweepAndPrune::remove(BodyHandle handle) {
+  Proxy &proxy{m_proxies[handle]};
+  for (std::size_t axis{0}; axis < 3; ++axis) {
+    // max is always after min, erase it first so the min position stays valid
+    eraseEndpoint(axis, proxy.maxEndpoint[axis]);
+    eraseEndpoint(axis, proxy.minEndpoint[axis]);
+  }
+  proxy.alive = false;
+  --m_count;
+}
+
+void SweepAndPrune::update(BodyHandle handle, const Bounds &bounds) {
+  Proxy &proxy{m_proxies[handle]};
+  for (std::size_t axis{0}; axis < 3; ++axis) {
+    proxy.min[axis]                                  = bounds.min[axis];
+    proxy.max[axis]                                  = bounds.max[axis];
+    m_endpoints[axis][proxy.minEndpoint[axis]].value = proxy.min[axis];
+    m_endpoints[axis][proxy.maxEndpoint[axis]].value = proxy.max[axis];
+  }
+}
+
+void SweepAndPrune::setStatic(BodyHandle handle, bool isStatic) {
+  m_proxies[handle].isStatic = isStatic;
+}
+
+void SweepAndPrune::eraseEndpoint(std::size_t axis, std::uint32_t position) {
+  std::vector<Endpoint> &endpoints{m_endpoints[axis]};
+  endpoints.erase(endpoints.begin() + position);
+  for (std::uint32_t i{position}; i < endpoints.size(); ++i) {
+    Proxy &moved{m_proxies[endpoints[i].getHandle()]};
+    if (endpoints[i].isMax())
+      moved.maxEndpoint[axis] = i;
+    else
+      moved.minEndpoint[axis] = i;
+  }
+}
+
+void SweepAndPrune::sortAxis(std::size_t axis) {
+  std::vector<Endpoint> &endpoints{m_endpoints[axis]};
+  for (std::uint32_t i{1}; i < endpoints.size(); ++i) {
+    Endpoint      endpoint{endpoints[i]};
+    std::uint32_t j{i};
+    // on equal values min endpoints go first so touching bounds are reported
+    while (j > 0 && (endpoints[j - 1].value > endpoint.value || (endpoints[j - 1].value == endpoint.value && endpoints[j - 1].isMax() && !endpoint.isMax()))) {
+      endpoints[j] = endpoints[j - 1];
+      Proxy &moved{m_proxies[endpoints[j].getHandle()]};
+      if (endpoints[j].isMax())
+        moved.maxEndpoint[axis] = j;
+      else
+        moved.minEndpoint[axis] = j;
+      --j;
+    }
+    if (j != i) {
+      endpoints[j] = endpoint;
+      Proxy &moved{m_proxies[endpoint.getHandle()]};
+      if (endpoint.isMax())
+        moved.maxEndpoint[axis] = j;
+      else
+        moved.minEndpoint[axis] = j;
+    }
+  }
+}
+
+auto SweepAndPrune::chooseSweepAxis() const -> std::size_t {
+  if (m_count == 0)
+    return 0;
+
+  std::array<float, 3> sum{};
+  std::array<float, 3> sumSquared{};
+  for (const Proxy &proxy : m_proxies) {
+    if (!proxy.alive)
+      continue;
+    for (std::size_t axis{0}; axis < 3; ++axis) {
+      float center{(proxy.min[axis] + proxy.max[axis]) * 0.5f};
+      sum[axis] += center;
+      sumSquared[axis] += center * center;
+    }
+  }
+
+  std::size_t best{0};
+  float       bestVariance{-1.0f};
+  for (std::size_t axis{0}; axis < 3; ++axis) {
+    float mean{sum[axis] / static_cast<float>(m_count)};
+    float variance{sumSquared[axis] / static_cast<float>(m_count) - mean * mean};
+    if (variance > bestVariance) {
+      bestVariance = variance;
+      best         = axis;
+    }
+  }
+  return best;
+}
+
+bool SweepAndPrune::overlaps(const Proxy &a, const Proxy &b) const noexcept {
+  return a.min[0] <= b.max[0] && a.max[0] >= b.min[0] && a.min[1] <= b.max[1] && a.max[1] >= b.min[1] && a.min[2] <= b.max[2] && a.max[2] >= b.min[2];
+}
+
+void SweepAndPrune::findPairs(std::vector<BroadphasePair> &pairs) {
+  for (std::size_t axis{0}; axis < 3; ++axis)
+    sortAxis(axis);
+
+  m_active.clear();
+  for (const Endpoint &endpoint : m_endpoints[chooseSweepAxis()]) {
+    BodyHandle handle{endpoint.getHandle()};
+    if (endpoint.isMax()) {
+      auto it = std::find(m_active.begin(), m_active.end(), handle);
+      *it     = m_active.back();
+      m_active.pop_back();
+      continue;
+    }
+
+    const Proxy &proxy{m_proxies[handle]};
+    for (BodyHandle other : m_active) {
+      const Proxy &otherProxy{m_proxies[other]};
+      if (proxy.isStatic && otherProxy.isStatic)
+        continue;
+      if (overlaps(proxy, otherProxy))
+        pairs.push_back(BroadphasePair{std::min(handle, other), std::max(handle, other)});
+    }
+    m_active.push_back(handle);
+  }
+}
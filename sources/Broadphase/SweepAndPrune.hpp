@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "BodyStorage.hpp"
+#include "Shapes/Bounds.hpp"
+
+#include "Library.hpp"
+
+class BroadphasePair final {
+public:
+  BodyHandle first{INVALID_BODY};
+  BodyHandle second{INVALID_BODY};
+};
+
+// Incremental sweep and prune.
+// Every axis keeps a list of min / max endpoints that stays sorted between two frames,
+// so re-sorting it with an insertion sort only costs the few swaps caused by the bodies that moved.
+// Pairs are found by sweeping the axis on which the bodies are the most spread out.
+class SweepAndPrune final {
+public:
+  DLLATTRIB explicit SweepAndPrune() = default;
+
+  DLLATTRIB void insert(BodyHandle handle, const Bounds &bounds, bool isStatic);
+  DLLATTRIB void remove(BodyHandle handle);
+  DLLATTRIB void update(BodyHandle handle, const Bounds &bounds);
+  DLLATTRIB void setStatic(BodyHandle handle, bool isStatic);
+
+  // Sort the endpoints then fill pairs with every overlapping couple, static / static pairs are skipped
+  DLLATTRIB void findPairs(std::vector<BroadphasePair> &pairs);
+
+private:
+  class Endpoint final {
+  public:
+    float         value{0.0f};
+    std::uint32_t data{0};  // handle << 1 | isMax
+
+    [[nodiscard]] inline BodyHandle getHandle() const noexcept {
+      return static_cast<BodyHandle>(data >> 1);
+    }
+
+    [[nodiscard]] inline bool isMax() const noexcept {
+      return (data & 1) != 0;
+    }
+  };
+
+  class Proxy final {
+  public:
+    std::array<float, 3>         min{};
+    std::array<float, 3>         max{};
+    std::array<std::uint32_t, 3> minEndpoint{};  // position of the endpoints in m_endpoints
+    std::array<std::uint32_t, 3> maxEndpoint{};
+    bool                         alive{false};
+    bool                         isStatic{false};
+  };
+
+  void sortAxis(std::size_t axis);
+  void eraseEndpoint(std::size_t axis, std::uint32_t position);
+
+  [[nodiscard]] auto chooseSweepAxis() const -> std::size_t;
+  [[nodiscard]] bool overlaps(const Proxy &a, const Proxy &b) const noexcept;
+
+  std::array<std::vector<Endpoint>, 3> m_endpoints{};
+  std::vector<Proxy>                   m_proxies{};  // indexed by body handle
+  std::vector<BodyHandle>              m_active{};   // sweep scratch buffer
+  std::size_t                          m_count{0};
+};
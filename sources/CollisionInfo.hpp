@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <cfloat>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+#include "BodyStorage.hpp"
+#include "Maths/Math.hpp"
+#include "Library.hpp"
+
+class ContactPoint final {
+public:
+  ml::vec3 onA{0.0f, 0.0f, 0.0f};     // where did the collision occur, in WORLD SPACE on each object ...
+  ml::vec3 onB{0.0f, 0.0f, 0.0f};     // the solver subtracts the world centers of the bodies to get the lever arms
+  ml::vec3 normal{0.0f, 0.0f, 0.0f};  // In world space too
+  float    penetration{-FLT_MAX};
+
+  // impulses accumulated by the ContactSolver, kept from one step to the next to warm start it
+  float normalImpulse{0.0f};
+  float tangentImpulse1{0.0f};
+  float tangentImpulse2{0.0f};
+
+  std::uint32_t featureId{0};  // features of the two shapes giving the point, the same point keeps it from one step to the next
+};
+
+// Search directions of the vertices of the last GJK simplex of a pair: their support points are computed again with
+// the new transforms to start the next query close to the solution
+class SimplexCache final {
+public:
+  std::array<ml::vec3, 4> directions{};
+  std::uint32_t           count{0};
+
+public:
+  inline void flip() noexcept {  // the same simplex for the pair in the other order
+    for (std::uint32_t i{0}; i < count; ++i)
+      directions[i] *= -1.0f;
+  }
+};
+
+// Axis along which the last box/box query of a pair found the boxes apart, it is tested first at the next step and
+// usually still separates them
+class AxisCache final {
+public:
+  enum class Type : std::uint8_t {
+    NONE,         // the boxes were touching or weren't tested yet
+    FACE_FIRST,   // normal axisFirst of the first box
+    FACE_SECOND,  // normal axisSecond of the second box
+    EDGES,        // cross product of the edges along axisFirst and axisSecond
+  };
+
+  Type         type{Type::NONE};
+  std::uint8_t axisFirst{0};
+  std::uint8_t axisSecond{0};
+
+public:
+  inline void flip() noexcept {  // the same axis for the pair in the other order
+    if (type == Type::FACE_FIRST)
+      type = Type::FACE_SECOND;
+    else if (type == Type::FACE_SECOND)
+      type = Type::FACE_FIRST;
+    std::swap(axisFirst, axisSecond);
+  }
+};
+
+// What the narrowphase remembers of a pair from one step to the next
+class FeatureCache final {
+public:
+  SimplexCache simplex{};  // written by the GJK narrowphase
+  AxisCache    axis{};     // written by the box/box narrowphase
+
+public:
+  inline void flip() noexcept {
+    simplex.flip();
+    axis.flip();
+  }
+};
+
+// Pair of bodies found by the broadphase, touching or not: the entry of the features kept for it
+class PairFeatures final {
+public:
+  BodyHandle   firstCollider{INVALID_BODY};
+  BodyHandle   secondCollider{INVALID_BODY};
+  FeatureCache features{};
+  bool         isTested{false};  // found by the broadphase during the current step, the other pairs are removed
+};
+
+// Contact manifold of a pair of bodies: the points share the normal of the pair, a box resting on a face gets its 4 corners
+class CollisionInfo final {
+public:
+  static constexpr std::size_t MAX_POINTS{4};
+
+  std::array<ContactPoint, MAX_POINTS> points{};
+  std::uint32_t                        pointCount{0};
+  BodyHandle                           firstCollider{INVALID_BODY};
+  BodyHandle                           secondCollider{INVALID_BODY};
+  FeatureCache                         features{};  // read and written by the narrowphase
+  std::uint32_t                        touchingSteps{0};  // consecutive steps the pair has been touching before this one, 0 for a new contact
+  bool                                 isTouching{false};  // detected during the current step, the other collisions are removed
+
+public:
+  // Append a point, ignored once the manifold is full
+  DLLATTRIB void addContactPoint(const ml::vec3 &onA, const ml::vec3 &onB, const ml::vec3 &normal, float p, std::uint32_t featureId = 0);
+
+  [[nodiscard]] inline std::span<ContactPoint> getPoints() noexcept {
+    return std::span<ContactPoint>{points}.first(pointCount);
+  }
+
+  [[nodiscard]] inline std::span<const ContactPoint> getPoints() const noexcept {
+    return std::span<const ContactPoint>{points}.first(pointCount);
+  }
+};
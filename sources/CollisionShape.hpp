@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+#include <variant>
+
+#include "ICollisionShape.hpp"
+#include "ShapeType.hpp"
+#include "Shapes/AABB.hpp"
+#include "Shapes/Sphere.hpp"
+#include "Shapes/OBB.hpp"
+#include "Shapes/Capsule.hpp"
+
+// Every shape a body can have, stored by value so bodies can be kept contiguously without a heap allocation per shape.
+// The alternatives follow the order of ShapeType (minus UNKNOWN) so index() maps directly to a ShapeType.
+using CollisionShape = std::variant<AABB, Sphere, OBB, Capsule>;
+
+[[nodiscard]] inline ShapeType getShapeType(const CollisionShape &shape) noexcept {
+  return static_cast<ShapeType>(shape.index() + 1);
+}
+
+[[nodiscard]] inline const ICollisionShape &asCollisionShape(const CollisionShape &shape) noexcept {
+  return std::visit([](const ICollisionShape &concrete) -> const ICollisionShape & { return concrete; }, shape);
+}
+
+// Copy a polymorphic shape into a CollisionShape, used by the std::unique_ptr<ICollisionShape> API
+[[nodiscard]] inline CollisionShape makeCollisionShape(const ICollisionShape &shape) {
+  switch (shape.m_shapeType) {
+    case ShapeType::AABB:
+      return CollisionShape{std::in_place_type<AABB>, static_cast<const AABB &>(shape)};
+    case ShapeType::SPHERE:
+      return CollisionShape{std::in_place_type<Sphere>, static_cast<const Sphere &>(shape)};
+    case ShapeType::OBB:
+      return CollisionShape{std::in_place_type<OBB>, static_cast<const OBB &>(shape)};
+    case ShapeType::CAPSULE:
+      return CollisionShape{std::in_place_type<Capsule>, static_cast<const Capsule &>(shape)};
+    default:
+      break;
+  }
+  throw std::invalid_argument{"unknown collision shape type"};
+}
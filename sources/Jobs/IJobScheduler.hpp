@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "Library.hpp"
+
+// What the PhysicsSystem needs from a scheduler, implement it to run the physics on the job system of the host application.
+class IJobScheduler {
+public:
+  // Reference to the callable given to parallelFor, which outlives the call: unlike a std::function it never allocates
+  class Task final {
+  public:
+    template <class Function>
+      requires(!std::is_same_v<std::decay_t<Function>, Task>)
+    Task(const Function &function) noexcept  // not explicit so a lambda can be given to parallelFor
+        : m_function{&function}, m_call{[](const void *callable, std::size_t begin, std::size_t end) { (*static_cast<const Function *>(callable))(begin, end); }} {}
+
+    void operator()(std::size_t begin, std::size_t end) const {
+      m_call(m_function, begin, end);
+    }
+
+  private:
+    const void *m_function{nullptr};
+    void (*m_call)(const void *, std::size_t, std::size_t){nullptr};
+  };
+
+  DLLATTRIB virtual ~IJobScheduler() = default;
+
+  // Call task on ranges covering [0, count), each at most grainSize long, and return once they have all been run.
+  // The ranges may run concurrently, in any order. The range starting at i * grainSize is the chunk i.
+  // The calling thread is expected to help, the task can itself call parallelFor.
+  DLLATTRIB virtual void parallelFor(std::size_t count, std::size_t grainSize, const Task &task) = 0;
+
+  // Number of threads that may run tasks at the same time, the calling thread included
+  [[nodiscard]] DLLATTRIB virtual auto getWorkerCount() const noexcept -> std::size_t = 0;
+
+  // Index in [0, getWorkerCount()) of the worker running the calling task, no two tasks running at the same time share it.
+  // It lets a task write to per worker buffers without locking.
+  [[nodiscard]] DLLATTRIB virtual auto getCurrentWorker() const noexcept -> std::size_t = 0;
+};
@@ -0,0 +1,147 @@
+#include <algorithm>
+
+#include "JobSystem.hpp"
+
+namespace {
+  // worker running on this thread, only meaningful when tCurrentSystem is the system asking
+  thread_local const void *tCurrentSystem{nullptr};
+  thread_local std::size_t tCurrentWorker{0};
+}
+
+JobSystem::JobSystem(std::size_t workerCount) {
+  workerCount = std::max<std::size_t>(workerCount, 1);
+  for (std::size_t i{0}; i < workerCount; ++i)
+    m_queues.push_back(std::make_unique<WorkerQueue>());
+  for (std::size_t i{1}; i < workerCount; ++i)
+    m_threads.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock{m_sleepMutex};
+    m_isStopping = true;
+  }
+  m_wakeCondition.notify_all();
+  for (std::thread &thread : m_threads)
+    thread.join();
+}
+
+void JobSystem::parallelFor(std::size_t count, std::size_t grainSize, const Task &task) {
+  if (count == 0)
+    return;
+  grainSize = std::max<std::size_t>(grainSize, 1);
+  std::size_t chunkCount{(count + grainSize - 1) / grainSize};
+
+  if (m_threads.empty() || chunkCount == 1) {
+    for (std::size_t begin{0}; begin < count; begin += grainSize)
+      task(begin, std::min(begin + grainSize, count));
+    return;
+  }
+
+  Batch batch{};
+  batch.task = &task;
+  batch.remaining.store(chunkCount);
+
+  std::size_t worker{getCurrentWorker()};
+  {
+    // pushed in reverse so the owner pops the chunks in order
+    WorkerQueue &                queue{*m_queues[worker]};
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    for (std::size_t chunk{chunkCount}; chunk-- > 0;) {
+      std::size_t begin{chunk * grainSize};
+      pushBack(queue, Job{&batch, begin, std::min(begin + grainSize, count)});
+    }
+  }
+  m_queuedJobs.fetch_add(chunkCount);
+  {
+    std::lock_guard<std::mutex> lock{m_sleepMutex};
+  }
+  m_wakeCondition.notify_all();
+
+  // help instead of waiting, the jobs of other batches can be run too
+  while (batch.remaining.load() > 0) {
+    if (!runOne(worker))
+      std::this_thread::yield();
+  }
+
+  if (batch.error)
+    std::rethrow_exception(batch.error);
+}
+
+auto JobSystem::getWorkerCount() const noexcept -> std::size_t {
+  return m_queues.size();
+}
+
+void JobSystem::workerLoop(std::size_t worker) {
+  tCurrentSystem = this;
+  tCurrentWorker = worker;
+  while (true) {
+    if (runOne(worker))
+      continue;
+    std::unique_lock<std::mutex> lock{m_sleepMutex};
+    m_wakeCondition.wait(lock, [this] { return m_isStopping || m_queuedJobs.load() > 0; });
+    if (m_isStopping)
+      return;
+  }
+}
+
+bool JobSystem::runOne(std::size_t worker) {
+  Job job{};
+  if (!pop(worker, job) && !steal(worker, job))
+    return false;
+  m_queuedJobs.fetch_sub(1);
+  run(job);
+  return true;
+}
+
+bool JobSystem::pop(std::size_t worker, Job &job) {
+  WorkerQueue &                queue{*m_queues[worker]};
+  std::lock_guard<std::mutex> lock{queue.mutex};
+  if (queue.count == 0)
+    return false;
+  --queue.count;
+  job = queue.jobs[(queue.first + queue.count) & (queue.jobs.size() - 1)];
+  return true;
+}
+
+bool JobSystem::steal(std::size_t thief, Job &job) {
+  for (std::size_t offset{1}; offset < m_queues.size(); ++offset) {
+    WorkerQueue &                queue{*m_queues[(thief + offset) % m_queues.size()]};
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    if (queue.count == 0)
+      continue;
+    job         = queue.jobs[queue.first];
+    queue.first = (queue.first + 1) & (queue.jobs.size() - 1);
+    --queue.count;
+    return true;
+  }
+  return false;
+}
+
+void JobSystem::pushBack(WorkerQueue &queue, const Job &job) {
+  if (queue.count == queue.jobs.size()) {
+    std::vector<Job> jobs(std::max<std::size_t>(queue.jobs.size() * 2, 64));
+    for (std::size_t i{0}; i < queue.count; ++i)
+      jobs[i] = queue.jobs[(queue.first + i) & (queue.jobs.size() - 1)];
+    queue.jobs  = std::move(jobs);
+    queue.first = 0;
+  }
+  queue.jobs[(queue.first + queue.count) & (queue.jobs.size() - 1)] = job;
+  ++queue.count;
+}
+
+void JobSystem::run(const Job &job) {
+  try {
+    (*job.batch->task)(job.begin, job.end);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock{job.batch->errorMutex};
+    if (!job.batch->error)
+      job.batch->error = std::current_exception();
+  }
+  // last access to the batch, it lives on the stack of the thread waiting for it
+  job.batch->remaining.fetch_sub(1);
+}
+
+auto JobSystem::getCurrentWorker() const noexcept -> std::size_t {
+  return tCurrentSystem == this ? tCurrentWorker : 0;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Jobs/IJobScheduler.hpp"
+
+#include "Library.hpp"
+
+// Work stealing scheduler: every worker owns a deque, pushes and pops the jobs it creates at the back (the most recent ones,
+// still warm in its cache) and steals from the front of the other deques when its own is empty.
+// The deques are ring buffers which only grow, a step of the physics doesn't allocate once they are big enough.
+// The thread calling parallelFor works on its batch instead of waiting, so a JobSystem of one worker runs everything inline.
+class JobSystem final : public IJobScheduler {
+public:
+  DLLATTRIB explicit JobSystem(std::size_t workerCount = std::thread::hardware_concurrency());  // workers including the calling thread, at least 1
+  DLLATTRIB ~JobSystem() override;
+
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  DLLATTRIB void               parallelFor(std::size_t count, std::size_t grainSize, const Task &task) override;  // rethrow the first exception thrown by a task
+  [[nodiscard]] DLLATTRIB auto getWorkerCount() const noexcept -> std::size_t override;
+  [[nodiscard]] DLLATTRIB auto getCurrentWorker() const noexcept -> std::size_t override;  // 0 for the threads which aren't workers of this system
+
+private:
+  class Batch final {
+  public:
+    const Task *             task{nullptr};
+    std::atomic<std::size_t> remaining{0};
+    std::mutex               errorMutex{};
+    std::exception_ptr       error{};
+  };
+
+  class Job final {
+  public:
+    Batch *     batch{nullptr};
+    std::size_t begin{0};
+    std::size_t end{0};
+  };
+
+  class WorkerQueue final {
+  public:
+    std::mutex       mutex{};
+    std::vector<Job> jobs{};  // ring buffer, its size is a power of two
+    std::size_t      first{0};
+    std::size_t      count{0};
+  };
+
+  void               workerLoop(std::size_t worker);
+  [[nodiscard]] bool runOne(std::size_t worker);  // pop or steal a job and run it, false if every queue was empty
+  [[nodiscard]] bool pop(std::size_t worker, Job &job);
+  [[nodiscard]] bool steal(std::size_t thief, Job &job);
+  static void        pushBack(WorkerQueue &queue, const Job &job);  // the caller holds the lock of the queue
+  static void        run(const Job &job);
+
+  std::vector<std::unique_ptr<WorkerQueue>> m_queues{};  // one per worker, 0 is shared by the threads calling parallelFor
+  std::vector<std::thread>                  m_threads{};
+  std::atomic<std::size_t>                  m_queuedJobs{0};
+  std::mutex                                m_sleepMutex{};
+  std::condition_variable                   m_wakeCondition{};
+  bool                                      m_isStopping{false};
+};
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "Vectors.hpp"
+#include "Simd.hpp"
 
 #include <array>
+#include <stdexcept>
 #include <vector>
 #include <iostream>
 
@@ -12,13 +14,13 @@ protected:
   Vector<Vector<T, height>, width> m_matrix;
 
 public:
-  explicit Matrix();
-  explicit Matrix(const std::array<std::array<T, height>, width> &array);
+  constexpr explicit Matrix();
+  constexpr explicit Matrix(const std::array<std::array<T, height>, width> &array);
   explicit Matrix(const std::vector<std::vector<T>> &array);
-  explicit Matrix(Vector<Vector<T, height>, width> array);
+  constexpr explicit Matrix(Vector<Vector<T, height>, width> array);
   ~Matrix() = default;
 
-  Matrix<T, width, height> &operator=(const Matrix<T, width, height> &v);
+  constexpr Matrix<T, width, height> &operator=(const Matrix<T, width, height> &v);
   [[nodiscard]] bool        operator!=(const Matrix<T, width, height> &v) const;
   [[nodiscard]] bool        operator==(const Matrix<T, width, height> &v) const;
   [[nodiscard]] bool        operator>(const Matrix<T, width, height> &v) const;
@@ -28,8 +30,8 @@ public:
   // this < v will be true if this = {0, 0} and v = {1, 1} but if this = {1, 0} and v = {0, 1} this will be false
   [[nodiscard]] bool                            operator>=(const Matrix<T, width, height> &v) const;
   [[nodiscard]] bool                            operator<=(const Matrix<T, width, height> &v) const;
-  [[nodiscard]] Vector<T, height> &             operator[](std::uint32_t);
-  [[nodiscard]] const Vector<T, height> &       operator[](std::uint32_t) const;
+  [[nodiscard]] constexpr Vector<T, height> &   operator[](std::uint32_t);
+  [[nodiscard]] constexpr const Vector<T, height> &operator[](std::uint32_t) const;
   [[nodiscard]] Vector<T, height> &             operator()(std::uint32_t);
   [[nodiscard]] Matrix<T, width, height>        operator+(const Matrix<T, width, height> &v) const;
   [[nodiscard]] Matrix<T, width, height>        operator-(const Matrix<T, width, height> &v) const;
@@ -40,10 +42,10 @@ public:
   [[nodiscard]] Vector<T, width - 1>            operator*(const Vector<T, width - 1> &v) const;
   [[nodiscard]] Matrix<T, width, height>        operator*(const float &v) const;
   [[nodiscard]] static Matrix<T, width, height> mix(const Matrix<T, width, height> &a, const Matrix<T, width, height> &b, const float &c);
-  [[nodiscard]] Matrix<T, height, width>        transpose() const;
-  [[nodiscard]] Matrix<T, height, width>        inverse();
+  [[nodiscard]] constexpr Matrix<T, height, width> transpose() const;
+  [[nodiscard]] constexpr Matrix<T, height, width> inverse() const;  // closed form up to 4x4, throw std::runtime_error if the matrix is singular
   [[nodiscard]] size_t                          hash() const;
-  [[nodiscard]] T                               determinant();
+  [[nodiscard]] constexpr T                     determinant() const;  // closed form up to 4x4, Gaussian elimination above
   void                                          getCofactor(Matrix<T, width, height> &tmp, int p, int q);
   [[nodiscard]] Matrix<T, width, height>        operator^(const Matrix<T, width, height> &v) const;
   Matrix<T, width, height> &                    operator+=(const Matrix<T, width, height> &v);  // This function return a reference to itself to be able to chain itself or with other but the return value may not be used.
@@ -52,10 +54,10 @@ public:
 };
 
 template <class T, std::size_t width, std::size_t height>
-inline Matrix<T, width, height>::Matrix() : m_matrix{} {}
+constexpr inline Matrix<T, width, height>::Matrix() : m_matrix{} {}
 
 template <class T, std::size_t width, std::size_t height>
-inline Matrix<T, width, height>::Matrix(const std::array<std::array<T, height>, width> &array) : m_matrix{} {
+constexpr inline Matrix<T, width, height>::Matrix(const std::array<std::array<T, height>, width> &array) : m_matrix{} {
   for (std::uint32_t i{0}; i < width; ++i)
     m_matrix[i] = Vector<T, height>{array[i]};
 }
@@ -67,7 +69,7 @@ inline Matrix<T, width, height>::Matrix(const std::vector<std::vector<T>> &array
 }
 
 template <class T, std::size_t width, std::size_t height>
-inline Matrix<T, width, height> &Matrix<T, width, height>::operator=(const Matrix<T, width, height> &v) {
+constexpr inline Matrix<T, width, height> &Matrix<T, width, height>::operator=(const Matrix<T, width, height> &v) {
   for (std::uint32_t i{0}; i < width; ++i)
     std::copy_n((&(v.m_matrix[i])[0]), height, (&(m_matrix[i])[0]));
   return *this;
@@ -104,7 +106,7 @@ inline bool Matrix<T, width, height>::operator<=(const Matrix<T, width, height>
 }
 
 template <class T, std::size_t width, std::size_t height>
-inline Vector<T, height> &Matrix<T, width, height>::operator[](std::uint32_t i) {
+constexpr inline Vector<T, height> &Matrix<T, width, height>::operator[](std::uint32_t i) {
   return m_matrix[i];
 }
 
@@ -164,7 +166,7 @@ inline Matrix<T, width, height> &Matrix<T, width, height>::operator*=(const Matr
 }
 
 template <class T, std::size_t width, std::size_t height>
-Matrix<T, width, height>::Matrix(Vector<Vector<T, height>, width> array) : m_matrix{array} {}
+constexpr Matrix<T, width, height>::Matrix(Vector<Vector<T, height>, width> array) : m_matrix{array} {}
 
 template <class T, std::size_t width, std::size_t height>
 Matrix<T, width, height> Matrix<T, width, height>::operator*(const int &v) const {
@@ -178,16 +180,16 @@ Matrix<T, width, height> Matrix<T, width, height>::operator*(const float &v) con
 }
 
 template <class T, std::size_t width, std::size_t height>
-Matrix<T, height, width> Matrix<T, width, height>::transpose() const {
+constexpr Matrix<T, height, width> Matrix<T, width, height>::transpose() const {
   Matrix<T, height, width> ret{};
-  for (int i = 0; i < height; ++i)
-    for (int j = 0; j < width; ++j)
+  for (std::uint32_t i = 0; i < height; ++i)
+    for (std::uint32_t j = 0; j < width; ++j)
       ret[i][j] = m_matrix[j][i];
   return ret;
 }
 
 template <class T, std::size_t width, std::size_t height>
-const Vector<T, height> &Matrix<T, width, height>::operator[](std::uint32_t i) const {
+constexpr const Vector<T, height> &Matrix<T, width, height>::operator[](std::uint32_t i) const {
   return m_matrix[i];
 }
 
@@ -203,30 +205,57 @@ Vector<T, height> Matrix<T, width, height>::operator*(const Vector<T, width> &v)
   return ret;
 }
 
-template <class T, std::size_t width, std::size_t height>
-T Matrix<T, width, height>::determinant() {
-  if (width != height)
-    return -1;
-  T D = 0;  // Initialize result
-
-  //  Base case : if matrix contains single element
-  if (width == 1)
-    return this[0][0];
-
-  Matrix<T, width, height> temp{};  // To store cofactors
-
-  int sign = 1;  // To store sign multiplier
-
-  // Iterate for each element of first row
-  for (int f = 0; f < width; f++) {
-    // Getting Cofactor of mat[0][f]
-    getCofactor(temp, 0, f);
-    D += sign * m_matrix[0][f] * determinantOfMatrix(temp, width - 1);
-    // terms are to be added with alternate sign
-    sign = -sign;
+// The determinant and the inverse don't depend on the storage order: inverse(transpose(M)) == transpose(inverse(M))
+template <class T, std::size_t width, std::size_t height>
+constexpr T Matrix<T, width, height>::determinant() const {
+  static_assert(width == height, "only square matrices have a determinant");
+  const auto &m{m_matrix};
+  if constexpr (width == 1) {
+    return m[0][0];
+  } else if constexpr (width == 2) {
+    return m[0][0] * m[1][1] - m[0][1] * m[1][0];
+  } else if constexpr (width == 3) {
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+  } else if constexpr (width == 4) {
+    // Laplace expansion along the first column using the 2x2 minors of the two last columns
+    T s0{m[2][2] * m[3][3] - m[2][3] * m[3][2]};
+    T s1{m[2][1] * m[3][3] - m[2][3] * m[3][1]};
+    T s2{m[2][1] * m[3][2] - m[2][2] * m[3][1]};
+    T s3{m[2][0] * m[3][3] - m[2][3] * m[3][0]};
+    T s4{m[2][0] * m[3][2] - m[2][2] * m[3][0]};
+    T s5{m[2][0] * m[3][1] - m[2][1] * m[3][0]};
+    return m[0][0] * (m[1][1] * s0 - m[1][2] * s1 + m[1][3] * s2) - m[0][1] * (m[1][0] * s0 - m[1][2] * s3 + m[1][3] * s4) + m[0][2] * (m[1][0] * s1 - m[1][1] * s3 + m[1][3] * s5) - m[0][3] * (m[1][0] * s2 - m[1][1] * s4 + m[1][2] * s5);
+  } else {
+    // Gaussian elimination with partial pivoting
+    Matrix<T, width, height> tmp{*this};
+    T                        det{1};
+    for (std::uint32_t col = 0; col < width; ++col) {
+      std::uint32_t pivot{col};
+      for (std::uint32_t row = col + 1; row < height; ++row) {
+        T candidate{tmp[row][col] < 0 ? -tmp[row][col] : tmp[row][col]};
+        T best{tmp[pivot][col] < 0 ? -tmp[pivot][col] : tmp[pivot][col]};
+        if (candidate > best)
+          pivot = row;
+      }
+      if (tmp[pivot][col] == 0)
+        return 0;
+      if (pivot != col) {
+        for (std::uint32_t k = 0; k < width; ++k) {
+          T swap{tmp[col][k]};
+          tmp[col][k]   = tmp[pivot][k];
+          tmp[pivot][k] = swap;
+        }
+        det = -det;
+      }
+      det *= tmp[col][col];
+      for (std::uint32_t row = col + 1; row < height; ++row) {
+        T factor{tmp[row][col] / tmp[col][col]};
+        for (std::uint32_t k = col; k < width; ++k)
+          tmp[row][k] -= factor * tmp[col][k];
+      }
+    }
+    return det;
   }
-
-  return D;
 }
 
 template <class T, std::size_t width, std::size_t height>
@@ -254,8 +283,73 @@ void Matrix<T, width, height>::getCofactor(Matrix<T, width, height> &tmp, int p,
 }
 
 template <class T, std::size_t width, std::size_t height>
-Matrix<T, height, width> Matrix<T, width, height>::inverse() {
-  return *this * (1 / determinant());
+constexpr Matrix<T, height, width> Matrix<T, width, height>::inverse() const {
+  static_assert(width == height && width >= 2 && width <= 4, "inverse is implemented for 2x2, 3x3 and 4x4 matrices");
+  const auto &             m{m_matrix};
+  Matrix<T, width, height> ret{};
+  if constexpr (width == 2) {
+    T det{determinant()};
+    if (det == 0)
+      throw std::runtime_error{"try to inverse a singular matrix"};
+    T invDet{1 / det};
+    ret[0][0] = m[1][1] * invDet;
+    ret[0][1] = -m[0][1] * invDet;
+    ret[1][0] = -m[1][0] * invDet;
+    ret[1][1] = m[0][0] * invDet;
+  } else if constexpr (width == 3) {
+    // adjugate divided by the determinant, the cofactors are reused for the determinant
+    T c00{m[1][1] * m[2][2] - m[1][2] * m[2][1]};
+    T c01{m[1][2] * m[2][0] - m[1][0] * m[2][2]};
+    T c02{m[1][0] * m[2][1] - m[1][1] * m[2][0]};
+    T det{m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02};
+    if (det == 0)
+      throw std::runtime_error{"try to inverse a singular matrix"};
+    T invDet{1 / det};
+    ret[0][0] = c00 * invDet;
+    ret[1][0] = c01 * invDet;
+    ret[2][0] = c02 * invDet;
+    ret[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * invDet;
+    ret[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * invDet;
+    ret[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * invDet;
+    ret[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * invDet;
+    ret[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * invDet;
+    ret[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * invDet;
+  } else {
+    // adjugate from the 2x2 minors of the two first and the two last columns
+    T s0{m[0][0] * m[1][1] - m[1][0] * m[0][1]};
+    T s1{m[0][0] * m[1][2] - m[1][0] * m[0][2]};
+    T s2{m[0][0] * m[1][3] - m[1][0] * m[0][3]};
+    T s3{m[0][1] * m[1][2] - m[1][1] * m[0][2]};
+    T s4{m[0][1] * m[1][3] - m[1][1] * m[0][3]};
+    T s5{m[0][2] * m[1][3] - m[1][2] * m[0][3]};
+    T c5{m[2][2] * m[3][3] - m[3][2] * m[2][3]};
+    T c4{m[2][1] * m[3][3] - m[3][1] * m[2][3]};
+    T c3{m[2][1] * m[3][2] - m[3][1] * m[2][2]};
+    T c2{m[2][0] * m[3][3] - m[3][0] * m[2][3]};
+    T c1{m[2][0] * m[3][2] - m[3][0] * m[2][2]};
+    T c0{m[2][0] * m[3][1] - m[3][0] * m[2][1]};
+    T det{s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0};
+    if (det == 0)
+      throw std::runtime_error{"try to inverse a singular matrix"};
+    T invDet{1 / det};
+    ret[0][0] = (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * invDet;
+    ret[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * invDet;
+    ret[0][2] = (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * invDet;
+    ret[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * invDet;
+    ret[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * invDet;
+    ret[1][1] = (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * invDet;
+    ret[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * invDet;
+    ret[1][3] = (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * invDet;
+    ret[2][0] = (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * invDet;
+    ret[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * invDet;
+    ret[2][2] = (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * invDet;
+    ret[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * invDet;
+    ret[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * invDet;
+    ret[3][1] = (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * invDet;
+    ret[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * invDet;
+    ret[3][3] = (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * invDet;
+  }
+  return ret;
 }
 
 template <class T, std::size_t width, std::size_t height>
@@ -294,14 +388,43 @@ Vector<T, width - 1> Matrix<T, width, height>::operator*(const Vector<T, width -
   return ret2;
 }
 
+#if ML_SIMD_SSE
+// 128 bits specializations of the 4x4 float matrices, the columns are summed in the same order as the loops above
+template <>
+inline Vector<float, 4> Matrix<float, 4, 4>::operator*(const Vector<float, 4> &v) const {
+  Vector<float, 4> ret{};
+  ml::simd::store4(&ret[0], ml::simd::transform(&m_matrix[0][0], &m_matrix[1][0], &m_matrix[2][0], &m_matrix[3][0], v[0], v[1], v[2], v[3]));
+  return ret;
+}
+
+// homogeneous transform of a point, the w component is 1
+template <>
+inline Vector<float, 3> Matrix<float, 4, 4>::operator*(const Vector<float, 3> &v) const {
+  Vector<float, 3> ret{};
+  ml::simd::store3(&ret[0], ml::simd::transform(&m_matrix[0][0], &m_matrix[1][0], &m_matrix[2][0], &m_matrix[3][0], v[0], v[1], v[2], 1.0f));
+  return ret;
+}
+
+template <>
+inline Matrix<float, 4, 4> Matrix<float, 4, 4>::operator*(const Matrix<float, 4, 4> &v) const {
+  // ret[i][j] = sum of m_matrix[i][k] * v[k][j]: the column i of the result is v applied to the column i of this matrix
+  Matrix<float, 4, 4> ret{};
+  for (std::uint32_t i{0}; i < 4; ++i) {
+    const Vector<float, 4> &column{m_matrix[i]};
+    ml::simd::store4(&ret[i][0], ml::simd::transform(&v[0][0], &v[1][0], &v[2][0], &v[3][0], column[0], column[1], column[2], column[3]));
+  }
+  return ret;
+}
+#endif
+
 template <class T>
 class Matrix4 : public Matrix<T, 4, 4> {
 public:
-  explicit Matrix4();
-  explicit Matrix4(T x, T y = 1.0f, T z = 1.0f, T w = 1.0f);  // identity multiplied by vector [a, b, c, d]
-  explicit Matrix4(const std::array<std::array<T, 4>, 4> &array);
+  constexpr explicit Matrix4();
+  constexpr explicit Matrix4(T x, T y = 1.0f, T z = 1.0f, T w = 1.0f);  // identity multiplied by vector [a, b, c, d]
+  constexpr explicit Matrix4(const std::array<std::array<T, 4>, 4> &array);
   explicit Matrix4(const std::vector<std::vector<T>> &array);
-  Matrix4(const Matrix<T, 4, 4> &v);
+  constexpr Matrix4(const Matrix<T, 4, 4> &v);
   [[nodiscard]] static Matrix4<T> lookAt(const Vector<T, 3> &eye, const Vector<T, 3> &center, const Vector<T, 3> &up);
   [[nodiscard]] static Matrix4<T> perspective(T fovy, T aspect, T zNear, T zFar);
   [[nodiscard]] Matrix4<T>        scale(T a, T b, T c);
@@ -312,6 +435,10 @@ public:
   [[nodiscard]] Matrix<T, 3, 3>   getRotation() const;
   void                            setTranslation(const Vector3<T> &vec);
   void                            setRotation(const Matrix<T, 3, 3> &matrix);
+  // Inverse of a matrix whose last row is [0, 0, 0, 1]: inverse of the 3x3 block, then the translation is brought back through it
+  [[nodiscard]] constexpr Matrix4<T> affineInverse() const;
+  // Inverse of a rotation + translation (no scale): the rotation is only transposed
+  [[nodiscard]] constexpr Matrix4<T> rigidInverse() const;
 };
 
 template <class T>
@@ -342,16 +469,16 @@ Matrix4<T> Matrix4<T>::perspective(T fovy, T aspect, T zNear, T zFar) {
 }
 
 template <class T>
-Matrix4<T>::Matrix4(const std::array<std::array<T, 4>, 4> &array) : Matrix<T, 4, 4>(array) {}
+constexpr Matrix4<T>::Matrix4(const std::array<std::array<T, 4>, 4> &array) : Matrix<T, 4, 4>(array) {}
 
 template <class T>
 Matrix4<T>::Matrix4(const std::vector<std::vector<T>> &array) : Matrix<T, 4, 4>(array) {}
 
 template <class T>
-Matrix4<T>::Matrix4() : Matrix<T, 4, 4>() {}
+constexpr Matrix4<T>::Matrix4() : Matrix<T, 4, 4>() {}
 
 template <class T>
-Matrix4<T>::Matrix4(T x, T y, T z, T w) : Matrix<T, 4, 4>{} {
+constexpr Matrix4<T>::Matrix4(T x, T y, T z, T w) : Matrix<T, 4, 4>{} {
   this->m_matrix[0][0] = x;
   this->m_matrix[1][1] = y;
   this->m_matrix[2][2] = z;
@@ -399,6 +526,39 @@ void Matrix4<T>::setRotation(const Matrix<T, 3, 3> &matrix) {
   this->m_matrix[2][2] = matrix[2][2];
 }
 
+template <class T>
+constexpr Matrix4<T> Matrix4<T>::affineInverse() const {
+  const auto &m{this->m_matrix};
+  Matrix<T, 3, 3> inverseBlock{std::array<std::array<T, 3>, 3>{
+  std::array<T, 3>{m[0][0], m[0][1], m[0][2]},
+  std::array<T, 3>{m[1][0], m[1][1], m[1][2]},
+  std::array<T, 3>{m[2][0], m[2][1], m[2][2]},
+  }};
+  inverseBlock = inverseBlock.inverse();
+
+  Matrix4<T> ret{};
+  for (std::uint32_t col = 0; col < 3; ++col)
+    for (std::uint32_t row = 0; row < 3; ++row)
+      ret[col][row] = inverseBlock[col][row];
+  for (std::uint32_t row = 0; row < 3; ++row)
+    ret[3][row] = -(inverseBlock[0][row] * m[3][0] + inverseBlock[1][row] * m[3][1] + inverseBlock[2][row] * m[3][2]);
+  ret[3][3] = 1;
+  return ret;
+}
+
+template <class T>
+constexpr Matrix4<T> Matrix4<T>::rigidInverse() const {
+  const auto &m{this->m_matrix};
+  Matrix4<T>  ret{};
+  for (std::uint32_t col = 0; col < 3; ++col)
+    for (std::uint32_t row = 0; row < 3; ++row)
+      ret[col][row] = m[row][col];
+  for (std::uint32_t row = 0; row < 3; ++row)
+    ret[3][row] = -(m[row][0] * m[3][0] + m[row][1] * m[3][1] + m[row][2] * m[3][2]);
+  ret[3][3] = 1;
+  return ret;
+}
+
 template <class T>
 Matrix<T, 3, 3> Matrix4<T>::getRotation() const {
   return Matrix<T, 3, 3>{std::array<std::array<T, 3>, 3>{
@@ -424,7 +584,7 @@ Matrix4<T> Matrix4<T>::perspectiveRH(T fovy, T aspect, T near, T far) {
 }
 
 template <class T>
-Matrix4<T>::Matrix4(const Matrix<T, 4, 4> &v) : Matrix<T, 4, 4>(v) {}
+constexpr Matrix4<T>::Matrix4(const Matrix<T, 4, 4> &v) : Matrix<T, 4, 4>(v) {}
 template <class T>
 Matrix4<T> Matrix4<T>::rotation(T angle, Vector3<T> axis) {
   axis.normalize();
@@ -58,15 +58,35 @@ Quaternion Quaternion::fromMatrix(Matrix<float, 4, 4> mat) {
   return Quaternion(x, y, z, w);
 }
 
+// mat is stored [column][row], the largest diagonal term is used so rotations close to half a turn stay accurate
 Quaternion Quaternion::fromMatrix(Matrix<float, 3, 3> mat) {
-  float w = sqrt(std::max(0.000000001f, (1.0f + mat[0][0] + mat[1][1] + mat[2][2]))) * 0.5f;
-
-  float qrFour      = 4.0f * w;
-  float qrFourRecip = 1.0f / qrFour;
-
-  float x = (mat[1][2] - mat[2][1]) * qrFourRecip;
-  float y = (mat[2][0] - mat[0][2]) * qrFourRecip;
-  float z = (mat[0][1] - mat[1][0]) * qrFourRecip;
+  float w, x, y, z;
+  float diagonal = mat[0][0] + mat[1][1] + mat[2][2];
+  if (diagonal > 0) {
+    float w4 = sqrt(diagonal + 1.0f) * 2.0f;
+    w        = w4 / 4.0f;
+    x        = (mat[1][2] - mat[2][1]) / w4;
+    y        = (mat[2][0] - mat[0][2]) / w4;
+    z        = (mat[0][1] - mat[1][0]) / w4;
+  } else if ((mat[0][0] > mat[1][1]) && (mat[0][0] > mat[2][2])) {
+    float x4 = sqrt(1.0f + mat[0][0] - mat[1][1] - mat[2][2]) * 2.0f;
+    w        = (mat[1][2] - mat[2][1]) / x4;
+    x        = x4 / 4.0f;
+    y        = (mat[0][1] + mat[1][0]) / x4;
+    z        = (mat[0][2] + mat[2][0]) / x4;
+  } else if (mat[1][1] > mat[2][2]) {
+    float y4 = sqrt(1.0f + mat[1][1] - mat[0][0] - mat[2][2]) * 2.0f;
+    w        = (mat[2][0] - mat[0][2]) / y4;
+    x        = (mat[0][1] + mat[1][0]) / y4;
+    y        = y4 / 4.0f;
+    z        = (mat[1][2] + mat[2][1]) / y4;
+  } else {
+    float z4 = sqrt(1.0f + mat[2][2] - mat[0][0] - mat[1][1]) * 2.0f;
+    w        = (mat[0][1] - mat[1][0]) / z4;
+    x        = (mat[0][2] + mat[2][0]) / z4;
+    y        = (mat[1][2] + mat[2][1]) / z4;
+    z        = z4 / 4.0f;
+  }
   return Quaternion(x, y, z, w);
 }
 
@@ -0,0 +1,120 @@
+#pragma once
+
+// 128 bits backend of the math library, selected at build time:
+//   ML_SIMD_DISABLE    force the portable scalar code (cmake -DPHYSICS_SIMD=OFF)
+//   ML_SIMD_BIT_EXACT  only use kernels giving the same bits as the scalar code (cmake -DPHYSICS_SIMD_BIT_EXACT=ON):
+//                      no fused multiply-add and no reordered horizontal sums
+// The kernels are used by the float specializations of Vector and Matrix4, the generic templates stay scalar,
+// and by the structure of arrays code working on 4 objects at once (ContactSolver, the ray packets of the DynamicTree).
+
+#if !defined(ML_SIMD_DISABLE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ML_SIMD_SSE 1
+#include <emmintrin.h>
+#if defined(__FMA__) && !defined(ML_SIMD_BIT_EXACT)
+#define ML_SIMD_FMA 1
+#include <immintrin.h>
+#endif
+#else
+#define ML_SIMD_SSE 0
+#endif
+
+#if ML_SIMD_SSE
+
+namespace ml::simd {
+  using float4 = __m128;
+
+  [[nodiscard]] inline float4 load4(const float *data) noexcept {
+    return _mm_loadu_ps(data);
+  }
+
+  // only read 3 floats, the vectors are not padded. The 64 bits moves go through __m128i which may alias the floats
+  [[nodiscard]] inline float4 load3(const float *data) noexcept {
+    __m128 xy{_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(data)))};
+    return _mm_movelh_ps(xy, _mm_load_ss(data + 2));
+  }
+
+  inline void store4(float *data, float4 value) noexcept {
+    _mm_storeu_ps(data, value);
+  }
+
+  inline void store3(float *data, float4 value) noexcept {
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(data), _mm_castps_si128(value));
+    _mm_store_ss(data + 2, _mm_movehl_ps(value, value));
+  }
+
+  [[nodiscard]] inline float4 splat(float value) noexcept {
+    return _mm_set1_ps(value);
+  }
+
+  [[nodiscard]] inline float4 set4(float lane0, float lane1, float lane2, float lane3) noexcept {
+    return _mm_setr_ps(lane0, lane1, lane2, lane3);
+  }
+
+  [[nodiscard]] inline float4 zero() noexcept {
+    return _mm_setzero_ps();
+  }
+
+  [[nodiscard]] inline float4 add(float4 a, float4 b) noexcept {
+    return _mm_add_ps(a, b);
+  }
+
+  [[nodiscard]] inline float4 sub(float4 a, float4 b) noexcept {
+    return _mm_sub_ps(a, b);
+  }
+
+  [[nodiscard]] inline float4 mul(float4 a, float4 b) noexcept {
+    return _mm_mul_ps(a, b);
+  }
+
+  [[nodiscard]] inline float4 min(float4 a, float4 b) noexcept {
+    return _mm_min_ps(a, b);
+  }
+
+  [[nodiscard]] inline float4 max(float4 a, float4 b) noexcept {
+    return _mm_max_ps(a, b);
+  }
+
+  // all the bits of the lanes where a <= b are set
+  [[nodiscard]] inline float4 lessEqual(float4 a, float4 b) noexcept {
+    return _mm_cmple_ps(a, b);
+  }
+
+  // bit i is the sign bit of lane i, the lanes of a comparison set in a mask
+  [[nodiscard]] inline int signMask(float4 a) noexcept {
+    return _mm_movemask_ps(a);
+  }
+
+  // 1 / a, 0 in the lanes where a isn't strictly positive
+  [[nodiscard]] inline float4 inverseOrZero(float4 a) noexcept {
+    return _mm_and_ps(_mm_cmpgt_ps(a, _mm_setzero_ps()), _mm_div_ps(_mm_set1_ps(1.0f), a));
+  }
+
+  // accumulator + a * b, fused when allowed
+  [[nodiscard]] inline float4 madd(float4 a, float4 b, float4 accumulator) noexcept {
+#if ML_SIMD_FMA
+    return _mm_fmadd_ps(a, b, accumulator);
+#else
+    return _mm_add_ps(accumulator, _mm_mul_ps(a, b));
+#endif
+  }
+
+  // columns[0] * v.x + columns[1] * v.y + columns[2] * v.z + columns[3] * w, summed in that order like the scalar code
+  [[nodiscard]] inline float4 transform(const float *column0, const float *column1, const float *column2, const float *column3, float x, float y, float z, float w) noexcept {
+    float4 result{_mm_setzero_ps()};
+    result = madd(load4(column0), splat(x), result);
+    result = madd(load4(column1), splat(y), result);
+    result = madd(load4(column2), splat(z), result);
+    result = madd(load4(column3), splat(w), result);
+    return result;
+  }
+
+  [[nodiscard]] inline float dot4(float4 a, float4 b) noexcept {
+    float4 product{_mm_mul_ps(a, b)};
+    float4 high{_mm_movehl_ps(product, product)};                            // z w z w
+    float4 pairs{_mm_add_ps(product, high)};                                 // x+z y+w
+    float4 sum{_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 1, 1, 1)))};
+    return _mm_cvtss_f32(sum);
+  }
+}
+
+#endif
@@ -8,6 +8,8 @@
 #include <cmath>
 #include <iostream>
 
+#include "Simd.hpp"
+
 template <class T, std::size_t width, std::size_t height>
 class Matrix;
 
@@ -17,13 +19,13 @@ protected:
   std::array<T, size> m_array;
 
 public:
-  explicit Vector();
-  explicit Vector(const std::array<T, size> &array);
+  constexpr explicit Vector();
+  constexpr explicit Vector(const std::array<T, size> &array);
   explicit Vector(const std::vector<T> &array);
-  Vector(const Vector<T, size> &v);
+  constexpr Vector(const Vector<T, size> &v);
 
   ~Vector()                  = default;
-  Vector<T, size> &  operator=(const Vector<T, size> &v);
+  constexpr Vector<T, size> &operator=(const Vector<T, size> &v);
   [[nodiscard]] bool operator!=(const Vector<T, size> &v) const;
   [[nodiscard]] bool operator==(const Vector<T, size> &v) const;
   [[nodiscard]] bool operator==(const float &v) const;
@@ -34,8 +36,8 @@ public:
   // this < v will be true if this = {0, 0} and v = {1, 1} but if this = {1, 0} and v = {0, 1} this will be false
   [[nodiscard]] bool            operator>=(const Vector<T, size> &v) const;
   [[nodiscard]] bool            operator<=(const Vector<T, size> &v) const;
-  [[nodiscard]] T &             operator[](uint32_t);
-  [[nodiscard]] const T &       operator[](uint32_t) const;
+  [[nodiscard]] constexpr T &   operator[](uint32_t);
+  [[nodiscard]] constexpr const T &operator[](uint32_t) const;
   [[nodiscard]] T &             operator()(uint32_t);
   [[nodiscard]] Vector<T, size> operator+(const Vector<T, size> &v) const;
   [[nodiscard]] Vector<T, size> operator-(const Vector<T, size> &v) const;
@@ -79,10 +81,10 @@ Vector<T, size> &Vector<T, size>::operator*=(const float &v) {
 }
 
 template <class T, uint32_t size>
-inline Vector<T, size>::Vector() : m_array() {}  // fix for aurelien
+constexpr inline Vector<T, size>::Vector() : m_array() {}  // fix for aurelien
 
 template <class T, uint32_t size>
-inline Vector<T, size>::Vector(const std::array<T, size> &array) : m_array{array} {}
+constexpr inline Vector<T, size>::Vector(const std::array<T, size> &array) : m_array{array} {}
 
 template <class T, uint32_t size>
 inline Vector<T, size>::Vector(const std::vector<T> &array) : m_array{} {
@@ -90,7 +92,7 @@ inline Vector<T, size>::Vector(const std::vector<T> &array) : m_array{} {
 }
 
 template <class T, uint32_t size>
-inline Vector<T, size> &Vector<T, size>::operator=(const Vector<T, size> &v) {
+constexpr inline Vector<T, size> &Vector<T, size>::operator=(const Vector<T, size> &v) {
   std::copy_n(v.m_array.begin(), size, m_array.begin());
   return *this;
 }
@@ -150,7 +152,7 @@ inline bool Vector<T, size>::operator<=(const Vector<T, size> &v) const {
 }
 
 template <class T, uint32_t size>
-inline T &Vector<T, size>::operator[](uint32_t i) {
+constexpr inline T &Vector<T, size>::operator[](uint32_t i) {
   return m_array[i];
 }
 
@@ -293,7 +295,7 @@ Vector<T, size> Vector<T, size>::operator/(const float &v) const {
 }
 
 template <class T, uint32_t size>
-const T &Vector<T, size>::operator[](uint32_t i) const {
+constexpr const T &Vector<T, size>::operator[](uint32_t i) const {
   return m_array[i];
 }
 
@@ -343,7 +345,7 @@ Vector<T, size> Vector<T, size>::rotate(const T &angle, const Vector<T, size> &n
 }
 
 template <class T, uint32_t size>
-Vector<T, size>::Vector(const Vector<T, size> &v) : m_array{v.m_array} {}
+constexpr Vector<T, size>::Vector(const Vector<T, size> &v) : m_array{v.m_array} {}
 
 template <class T, uint32_t size>
 Vector<T, size> Vector<T, size>::clamp(const Vector<T, size> &min, const Vector<T, size> &max) const {
@@ -365,9 +367,101 @@ size_t Vector<T, size>::hash() const {
   return seed;
 }
 
+#if ML_SIMD_SSE
+// 128 bits specializations of the float vectors, element wise operations give the same results as the loops above
+template <>
+inline Vector<float, 4> Vector<float, 4>::operator+(const Vector<float, 4> &v) const {
+  Vector<float, 4> ret{};
+  ml::simd::store4(ret.m_array.data(), ml::simd::add(ml::simd::load4(m_array.data()), ml::simd::load4(v.m_array.data())));
+  return ret;
+}
+
+template <>
+inline Vector<float, 4> Vector<float, 4>::operator-(const Vector<float, 4> &v) const {
+  Vector<float, 4> ret{};
+  ml::simd::store4(ret.m_array.data(), ml::simd::sub(ml::simd::load4(m_array.data()), ml::simd::load4(v.m_array.data())));
+  return ret;
+}
+
+template <>
+inline Vector<float, 4> Vector<float, 4>::operator*(const Vector<float, 4> &v) const {
+  Vector<float, 4> ret{};
+  ml::simd::store4(ret.m_array.data(), ml::simd::mul(ml::simd::load4(m_array.data()), ml::simd::load4(v.m_array.data())));
+  return ret;
+}
+
+template <>
+inline Vector<float, 4> Vector<float, 4>::operator*(const float &v) const {
+  Vector<float, 4> ret{};
+  ml::simd::store4(ret.m_array.data(), ml::simd::mul(ml::simd::load4(m_array.data()), ml::simd::splat(v)));
+  return ret;
+}
+
+template <>
+inline Vector<float, 4> &Vector<float, 4>::operator+=(const Vector<float, 4> &v) {
+  ml::simd::store4(m_array.data(), ml::simd::add(ml::simd::load4(m_array.data()), ml::simd::load4(v.m_array.data())));
+  return *this;
+}
+
+template <>
+inline Vector<float, 4> &Vector<float, 4>::operator-=(const Vector<float, 4> &v) {
+  ml::simd::store4(m_array.data(), ml::simd::sub(ml::simd::load4(m_array.data()), ml::simd::load4(v.m_array.data())));
+  return *this;
+}
+
+#if !defined(ML_SIMD_BIT_EXACT)
+// the horizontal sum is done in another order than the scalar loop
+template <>
+inline float Vector<float, 4>::dot(const Vector<float, 4> &b) const {
+  return ml::simd::dot4(ml::simd::load4(m_array.data()), ml::simd::load4(b.m_array.data()));
+}
+#endif
+
+template <>
+inline Vector<float, 3> Vector<float, 3>::operator+(const Vector<float, 3> &v) const {
+  Vector<float, 3> ret{};
+  ml::simd::store3(ret.m_array.data(), ml::simd::add(ml::simd::load3(m_array.data()), ml::simd::load3(v.m_array.data())));
+  return ret;
+}
+
+template <>
+inline Vector<float, 3> Vector<float, 3>::operator-(const Vector<float, 3> &v) const {
+  Vector<float, 3> ret{};
+  ml::simd::store3(ret.m_array.data(), ml::simd::sub(ml::simd::load3(m_array.data()), ml::simd::load3(v.m_array.data())));
+  return ret;
+}
+
+template <>
+inline Vector<float, 3> Vector<float, 3>::operator*(const Vector<float, 3> &v) const {
+  Vector<float, 3> ret{};
+  ml::simd::store3(ret.m_array.data(), ml::simd::mul(ml::simd::load3(m_array.data()), ml::simd::load3(v.m_array.data())));
+  return ret;
+}
+
+template <>
+inline Vector<float, 3> Vector<float, 3>::operator*(const float &v) const {
+  Vector<float, 3> ret{};
+  ml::simd::store3(ret.m_array.data(), ml::simd::mul(ml::simd::load3(m_array.data()), ml::simd::splat(v)));
+  return ret;
+}
+
+template <>
+inline Vector<float, 3> &Vector<float, 3>::operator+=(const Vector<float, 3> &v) {
+  ml::simd::store3(m_array.data(), ml::simd::add(ml::simd::load3(m_array.data()), ml::simd::load3(v.m_array.data())));
+  return *this;
+}
+
+template <>
+inline Vector<float, 3> &Vector<float, 3>::operator-=(const Vector<float, 3> &v) {
+  ml::simd::store3(m_array.data(), ml::simd::sub(ml::simd::load3(m_array.data()), ml::simd::load3(v.m_array.data())));
+  return *this;
+}
+#endif
+
 template <class T>
 class Vector3 : public Vector<T, 3> {
 public:
+  Vector3();  // zero vector, needed to store them in std::array
   explicit Vector3(T a, T b, T c);
   Vector3(const Vector3<T> &v);
   Vector3(const Vector<T, 3> &v);  // need to not explicit because used for operations
@@ -382,6 +476,12 @@ public:
   [[nodiscard]] Vector3<T> cross(const Vector3<T> &b) const;
 };
 
+template <class T>
+Vector3<T>::Vector3() : Vector<T, 3>{std::array<T, 3>{0, 0, 0}},
+                        x{this->m_array[0]},
+                        y{this->m_array[1]},
+                        z{this->m_array[2]} {}
+
 template <class T>
 Vector3<T>::Vector3(T a, T b, T c) : Vector<T, 3>{std::array<T, 3>{a, b, c}},
                                      x{this->m_array[0]},
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <memory>
+#include <new>
+
+#include "Arena.hpp"
+
+namespace {
+  constexpr std::align_val_t BLOCK_ALIGNMENT{alignof(std::max_align_t)};
+}
+
+Arena::Arena(std::size_t capacity) {
+  if (capacity > 0)
+    addBlock(capacity);
+}
+
+Arena::~Arena() {
+  releaseBlocks();
+}
+
+void Arena::reset() {
+  if (m_blocks.size() > 1) {
+    std::size_t capacity{getCapacity()};
+    releaseBlocks();
+    addBlock(capacity);
+  }
+  m_offset    = 0;
+  m_usedBytes = 0;
+}
+
+auto Arena::getUsedBytes() const noexcept -> std::size_t {
+  return m_usedBytes;
+}
+
+auto Arena::getCapacity() const noexcept -> std::size_t {
+  std::size_t capacity{0};
+  for (const Block &block : m_blocks)
+    capacity += block.size;
+  return capacity;
+}
+
+auto Arena::getBlockAllocations() const noexcept -> std::size_t {
+  return m_blockAllocations;
+}
+
+void *Arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+  if (!m_blocks.empty()) {
+    const Block &block{m_blocks.back()};
+    void *       data{block.data + m_offset};
+    std::size_t  space{block.size - m_offset};
+    if (std::align(alignment, bytes, data, space) != nullptr) {
+      m_offset = static_cast<std::size_t>(static_cast<std::byte *>(data) - block.data) + bytes;
+      m_usedBytes += bytes;
+      return data;
+    }
+  }
+
+  // the blocks double so an update which doesn't fit only allocates a few of them
+  std::size_t previous{m_blocks.empty() ? DEFAULT_CAPACITY : m_blocks.back().size};
+  addBlock(std::max(previous * 2, bytes + alignment));
+  return do_allocate(bytes, alignment);
+}
+
+void Arena::do_deallocate(void *, std::size_t, std::size_t) noexcept {
+  // the memory is given back by reset()
+}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+  return this == &other;
+}
+
+void Arena::addBlock(std::size_t size) {
+  m_blocks.push_back(Block{static_cast<std::byte *>(::operator new(size, BLOCK_ALIGNMENT)), size});
+  m_offset = 0;
+  ++m_blockAllocations;
+}
+
+void Arena::releaseBlocks() noexcept {
+  for (const Block &block : m_blocks)
+    ::operator delete(block.data, BLOCK_ALIGNMENT);
+  m_blocks.clear();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+#include "Library.hpp"
+
+// Linear allocator for the data living during a single update: allocating bumps an offset, deallocating does nothing
+// and reset() releases everything at once.
+// When an update didn't fit in the arena, reset() replaces its blocks by a single one as big as all of them together,
+// so the next updates needing as much memory don't call the global allocator anymore.
+// It isn't thread safe, every worker of the PhysicsSystem has its own arena.
+class Arena final : public std::pmr::memory_resource {
+public:
+  static constexpr std::size_t DEFAULT_CAPACITY{64 * 1024};
+
+  DLLATTRIB explicit Arena(std::size_t capacity = DEFAULT_CAPACITY);
+  DLLATTRIB ~Arena() override;
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  DLLATTRIB void               reset();  // invalidate everything allocated since the previous reset
+  [[nodiscard]] DLLATTRIB auto getUsedBytes() const noexcept -> std::size_t;
+  [[nodiscard]] DLLATTRIB auto getCapacity() const noexcept -> std::size_t;
+  [[nodiscard]] DLLATTRIB auto getBlockAllocations() const noexcept -> std::size_t;  // blocks taken from the global allocator since the creation
+
+private:
+  class Block final {
+  public:
+    std::byte * data{nullptr};
+    std::size_t size{0};
+  };
+
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void  do_deallocate(void *data, std::size_t bytes, std::size_t alignment) noexcept override;
+  bool  do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+  void addBlock(std::size_t size);
+  void releaseBlocks() noexcept;
+
+  std::vector<Block> m_blocks{};  // the last one is being filled
+  std::size_t        m_offset{0};  // in the last block
+  std::size_t        m_usedBytes{0};
+  std::size_t        m_blockAllocations{0};
+};
@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <cmath>
+#include <span>
+
+#include "BoxBox.hpp"
+
+namespace {
+  constexpr float       PARALLEL_TOLERANCE{1.0e-3f};    // length of the cross product of two edges under which they are parallel
+  constexpr float       FACE_RELATIVE_TOLERANCE{0.95f};  // another axis is only used when it is clearly shallower than the face
+  constexpr float       FACE_ABSOLUTE_TOLERANCE{0.01f};  // of the first box, the manifold doesn't flip between two equivalent faces
+  constexpr float       CLIP_TOLERANCE{1.0e-3f};         // a vertex that close to a clipping plane is kept, the ids of the
+                                                        // points of two boxes with aligned sides don't depend on the rounding
+  constexpr std::size_t MAX_CLIPPED{8};                 // a quad clipped by 4 planes
+
+  class FaceQuery final {
+  public:
+    float         separation{-FLT_MAX};
+    std::uint32_t axis{0};
+  };
+
+  class EdgeQuery final {
+  public:
+    float         separation{-FLT_MAX};
+    std::uint32_t axisFirst{0};
+    std::uint32_t axisSecond{0};
+    ml::vec3      normal{0.0f, 0.0f, 0.0f};  // from the first box to the second
+  };
+
+  class ClipVertex final {
+  public:
+    ml::vec3      position{0.0f, 0.0f, 0.0f};
+    std::uint32_t id{0};       // 0 to 3 for a corner of the incident face, the clipping plane and the corner before it otherwise
+    float         depth{0.0f};  // below the reference face
+  };
+
+  class Polygon final {
+  public:
+    std::array<ClipVertex, MAX_CLIPPED> vertices{};
+    std::size_t                         count{0};
+  };
+
+  auto projectedRadius(const Box &box, const ml::vec3 &axis) noexcept -> float {
+    return box.halfSizes.x * std::abs(box.axes[0].dot(axis)) + box.halfSizes.y * std::abs(box.axes[1].dot(axis)) + box.halfSizes.z * std::abs(box.axes[2].dot(axis));
+  }
+
+  // deepest separation along the face normals of reference, delta goes from reference to incident
+  auto queryFaces(const Box &reference, const Box &incident, const ml::vec3 &delta) noexcept -> FaceQuery {
+    FaceQuery query{};
+    for (std::uint32_t i{0}; i < 3; ++i) {
+      float separation{std::abs(delta.dot(reference.axes[i])) - reference.halfSizes[i] - projectedRadius(incident, reference.axes[i])};
+      if (separation > query.separation) {
+        query.separation = separation;
+        query.axis       = i;
+      }
+    }
+    return query;
+  }
+
+  auto queryEdges(const Box &first, const Box &second, const ml::vec3 &delta) noexcept -> EdgeQuery {
+    EdgeQuery query{};
+    for (std::uint32_t i{0}; i < 3; ++i) {
+      for (std::uint32_t j{0}; j < 3; ++j) {
+        ml::vec3 axis{first.axes[i].cross(second.axes[j])};
+        float    length{axis.length()};
+        if (length < PARALLEL_TOLERANCE)
+          continue;
+        axis = axis * (1.0f / length);
+        if (axis.dot(delta) < 0.0f)
+          axis = axis * -1.0f;
+        float separation{axis.dot(delta) - projectedRadius(first, axis) - projectedRadius(second, axis)};
+        if (separation > query.separation) {
+          query.separation = separation;
+          query.axisFirst  = i;
+          query.axisSecond = j;
+          query.normal     = axis;
+        }
+      }
+    }
+    return query;
+  }
+
+  // separation along the axis cached by the last query, -FLT_MAX when there is none or when its edges became parallel
+  auto cachedSeparation(const Box &first, const Box &second, const ml::vec3 &delta, const AxisCache &cache) noexcept -> float {
+    switch (cache.type) {
+      case AxisCache::Type::FACE_FIRST: {
+        const ml::vec3 &axis{first.axes[cache.axisFirst]};
+        return std::abs(delta.dot(axis)) - first.halfSizes[cache.axisFirst] - projectedRadius(second, axis);
+      }
+      case AxisCache::Type::FACE_SECOND: {
+        const ml::vec3 &axis{second.axes[cache.axisSecond]};
+        return std::abs(delta.dot(axis)) - second.halfSizes[cache.axisSecond] - projectedRadius(first, axis);
+      }
+      case AxisCache::Type::EDGES: {
+        ml::vec3 axis{first.axes[cache.axisFirst].cross(second.axes[cache.axisSecond])};
+        float    length{axis.length()};
+        if (length < PARALLEL_TOLERANCE)
+          return -FLT_MAX;
+        return (std::abs(delta.dot(axis)) - projectedRadius(first, axis) - projectedRadius(second, axis)) / length;  // all linear in the axis
+      }
+      default:
+        return -FLT_MAX;
+    }
+  }
+
+  // Sutherland-Hodgman: keep the part of input below the plane, the vertices created on it are tagged with the plane
+  void clip(const Polygon &input, const ml::vec3 &planeNormal, float planeOffset, std::uint32_t plane, Polygon &output) noexcept {
+    output.count = 0;
+    if (input.count == 0)
+      return;
+    const ClipVertex *previous{&input.vertices[input.count - 1]};
+    float             previousDistance{planeNormal.dot(previous->position) - planeOffset - CLIP_TOLERANCE};
+    for (std::size_t i{0}; i < input.count; ++i) {
+      const ClipVertex &current{input.vertices[i]};
+      float             distance{planeNormal.dot(current.position) - planeOffset - CLIP_TOLERANCE};
+      if ((previousDistance <= 0.0f) != (distance <= 0.0f)) {
+        float       t{previousDistance / (previousDistance - distance)};
+        ClipVertex &crossing{output.vertices[output.count++]};
+        crossing.position = previous->position + (current.position - previous->position) * t;
+        crossing.id       = ((plane + 1) << 4) | (previous->id & 0x0Fu);
+      }
+      if (distance <= 0.0f)
+        output.vertices[output.count++] = current;
+      previous         = &current;
+      previousDistance = distance;
+    }
+  }
+
+  auto signedArea(const ml::vec3 &a, const ml::vec3 &b, const ml::vec3 &c, const ml::vec3 &normal) noexcept -> float {
+    return ml::vec3{b - a}.cross(c - a).dot(normal);
+  }
+
+  // Keep the deepest point, the farthest one from it, the one making the largest triangle with them and the one adding
+  // the most area to that triangle: the quad covers the manifold and the deepest penetration is always solved
+  auto reduce(std::span<const ClipVertex> points, const ml::vec3 &normal, std::array<std::size_t, CollisionInfo::MAX_POINTS> &kept) noexcept -> std::size_t {
+    std::size_t first{0};
+    for (std::size_t i{1}; i < points.size(); ++i) {
+      if (points[i].depth > points[first].depth)
+        first = i;
+    }
+
+    std::size_t second{first};
+    float       bestDistance{-1.0f};
+    for (std::size_t i{0}; i < points.size(); ++i) {
+      ml::vec3 offset{points[i].position - points[first].position};
+      if (float distance{offset.dot(offset)}; i != first && distance > bestDistance) {
+        bestDistance = distance;
+        second       = i;
+      }
+    }
+
+    std::size_t third{first};
+    float       bestArea{0.0f};
+    for (std::size_t i{0}; i < points.size(); ++i) {
+      if (float area{std::abs(signedArea(points[first].position, points[second].position, points[i].position, normal))}; area > bestArea) {
+        bestArea = area;
+        third    = i;
+      }
+    }
+    kept = {first, second, third, 0};
+    if (third == first)
+      return 2;
+    // wind the triangle counterclockwise around the normal, the points outside of it have a negative area with an edge
+    if (signedArea(points[first].position, points[second].position, points[third].position, normal) < 0.0f)
+      std::swap(first, second);
+
+    std::size_t fourth{first};
+    float       bestAdded{0.0f};
+    for (std::size_t i{0}; i < points.size(); ++i) {
+      float added{std::max({
+      -signedArea(points[first].position, points[second].position, points[i].position, normal),
+      -signedArea(points[second].position, points[third].position, points[i].position, normal),
+      -signedArea(points[third].position, points[first].position, points[i].position, normal),
+      })};
+      if (added > bestAdded) {
+        bestAdded = added;
+        fourth    = i;
+      }
+    }
+    if (fourth == first)
+      return 3;
+    kept[3] = fourth;
+    return 4;
+  }
+
+  // normal is the outward normal of the reference face, it points to incident
+  bool collideFaces(const Box &reference, std::uint32_t axis, const ml::vec3 &normal, const Box &incident, bool isReferenceSecond, CollisionInfo &collisionInfo) noexcept {
+    // the incident face is the most anti-parallel to the reference one
+    std::uint32_t incidentAxis{0};
+    for (std::uint32_t i{1}; i < 3; ++i) {
+      if (std::abs(incident.axes[i].dot(normal)) > std::abs(incident.axes[incidentAxis].dot(normal)))
+        incidentAxis = i;
+    }
+    float         incidentSign{incident.axes[incidentAxis].dot(normal) > 0.0f ? -1.0f : 1.0f};
+    std::uint32_t u{(incidentAxis + 1) % 3};
+    std::uint32_t v{(incidentAxis + 2) % 3};
+    ml::vec3      incidentCenter{incident.center + incident.axes[incidentAxis] * (incidentSign * incident.halfSizes[incidentAxis])};
+    ml::vec3      uOffset{incident.axes[u] * incident.halfSizes[u]};
+    ml::vec3      vOffset{incident.axes[v] * incident.halfSizes[v]};
+
+    Polygon polygon{};
+    polygon.vertices[0] = ClipVertex{incidentCenter + uOffset + vOffset, 0};
+    polygon.vertices[1] = ClipVertex{incidentCenter - uOffset + vOffset, 1};
+    polygon.vertices[2] = ClipVertex{incidentCenter - uOffset - vOffset, 2};
+    polygon.vertices[3] = ClipVertex{incidentCenter + uOffset - vOffset, 3};
+    polygon.count       = 4;
+
+    // the 4 side planes of the reference face
+    Polygon clipped{};
+    for (std::uint32_t plane{0}; plane < 4; ++plane) {
+      const ml::vec3 &side{reference.axes[(axis + 1 + plane / 2) % 3]};
+      float           sign{plane % 2 == 0 ? 1.0f : -1.0f};
+      ml::vec3        planeNormal{side * sign};
+      clip(polygon, planeNormal, planeNormal.dot(reference.center) + reference.halfSizes[(axis + 1 + plane / 2) % 3], plane, clipped);
+      polygon = clipped;
+    }
+
+    // the points above the reference face aren't touching yet
+    ml::vec3                            referenceCenter{reference.center + normal * reference.halfSizes[axis]};
+    std::array<ClipVertex, MAX_CLIPPED> points{};
+    std::size_t                         pointCount{0};
+    for (std::size_t i{0}; i < polygon.count; ++i) {
+      float depth{-normal.dot(polygon.vertices[i].position - referenceCenter)};
+      if (depth >= 0.0f) {
+        points[pointCount]       = polygon.vertices[i];
+        points[pointCount].depth = depth;
+        ++pointCount;
+      }
+    }
+    if (pointCount == 0)
+      return false;
+
+    std::array<std::size_t, CollisionInfo::MAX_POINTS> kept{0, 1, 2, 3};
+    std::size_t                                         keptCount{pointCount};
+    if (pointCount > CollisionInfo::MAX_POINTS)
+      keptCount = reduce(std::span<const ClipVertex>{points}.first(pointCount), normal, kept);
+
+    std::uint32_t referenceFace{axis * 2 + (reference.axes[axis].dot(normal) > 0.0f ? 1u : 0u)};
+    std::uint32_t incidentFace{incidentAxis * 2 + (incidentSign > 0.0f ? 1u : 0u)};
+    std::uint32_t faces{(isReferenceSecond ? 1u << 16 : 0u) | (referenceFace << 12) | (incidentFace << 8)};
+    for (std::size_t i{0}; i < keptCount; ++i) {
+      const ClipVertex &point{points[kept[i]]};
+      ml::vec3          onReference{point.position + normal * point.depth};
+      if (isReferenceSecond)
+        collisionInfo.addContactPoint(point.position, onReference, normal * -1.0f, point.depth, faces | point.id);
+      else
+        collisionInfo.addContactPoint(onReference, point.position, normal, point.depth, faces | point.id);
+    }
+    return true;
+  }
+
+  // the closest points of the edges of the two boxes along the axes of query, the most advanced towards the other box
+  bool collideEdges(const Box &first, const Box &second, const EdgeQuery &query, CollisionInfo &collisionInfo) noexcept {
+    ml::vec3      centerFirst{first.center};
+    ml::vec3      centerSecond{second.center};
+    std::uint32_t signs{0};
+    for (std::uint32_t i{0}; i < 3; ++i) {
+      if (i != query.axisFirst) {
+        bool isPositive{first.axes[i].dot(query.normal) > 0.0f};
+        centerFirst += first.axes[i] * (isPositive ? first.halfSizes[i] : -first.halfSizes[i]);
+        signs |= (isPositive ? 1u : 0u) << i;
+      }
+      if (i != query.axisSecond) {
+        bool isPositive{second.axes[i].dot(query.normal) < 0.0f};
+        centerSecond += second.axes[i] * (isPositive ? second.halfSizes[i] : -second.halfSizes[i]);
+        signs |= (isPositive ? 1u : 0u) << (i + 3);
+      }
+    }
+
+    // closest points of the two lines, clamped to the edges
+    const ml::vec3 &directionFirst{first.axes[query.axisFirst]};
+    const ml::vec3 &directionSecond{second.axes[query.axisSecond]};
+    float           halfFirst{first.halfSizes[query.axisFirst]};
+    float           halfSecond{second.halfSizes[query.axisSecond]};
+    ml::vec3        offset{centerFirst - centerSecond};
+    float           b{directionFirst.dot(directionSecond)};
+    float           c{directionFirst.dot(offset)};
+    float           f{directionSecond.dot(offset)};
+    float           s{std::clamp((b * f - c) / (1.0f - b * b), -halfFirst, halfFirst)};
+    float           t{std::clamp(b * s + f, -halfSecond, halfSecond)};
+    s = std::clamp(b * t - c, -halfFirst, halfFirst);
+
+    std::uint32_t featureId{(1u << 20) | (query.axisFirst << 12) | (query.axisSecond << 8) | signs};
+    collisionInfo.addContactPoint(centerFirst + directionFirst * s, centerSecond + directionSecond * t, query.normal, -query.separation, featureId);
+    return true;
+  }
+}
+
+auto Box::fromOBB(const OBB &box, const ml::mat4 &transform) noexcept -> Box {
+  Box      world{};
+  ml::vec3 halfSizes{(box.getMax() - box.getMin()) * 0.5f};
+  world.center = transform * box.getLocalPosition();
+  for (std::uint32_t i{0}; i < 3; ++i) {
+    ml::vec3 column{transform[i][0], transform[i][1], transform[i][2]};
+    float    scale{column.length()};
+    world.axes[i]      = column * (1.0f / scale);
+    world.halfSizes[i] = halfSizes[i] * scale;
+  }
+  return world;
+}
+
+auto Box::fromBounds(const Bounds &bounds) noexcept -> Box {
+  Box world{};
+  world.center    = bounds.getCenter();
+  world.halfSizes = (bounds.max - bounds.min) * 0.5f;
+  return world;
+}
+
+bool collideBoxes(const Box &first, const Box &second, CollisionInfo &collisionInfo) noexcept {
+  ml::vec3   delta{second.center - first.center};
+  AxisCache &cache{collisionInfo.features.axis};
+  if (cachedSeparation(first, second, delta, cache) > 0.0f)
+    return false;
+
+  FaceQuery faceFirst{queryFaces(first, second, delta)};
+  if (faceFirst.separation > 0.0f) {
+    cache = AxisCache{AxisCache::Type::FACE_FIRST, static_cast<std::uint8_t>(faceFirst.axis), 0};
+    return false;
+  }
+  FaceQuery faceSecond{queryFaces(second, first, delta * -1.0f)};
+  if (faceSecond.separation > 0.0f) {
+    cache = AxisCache{AxisCache::Type::FACE_SECOND, 0, static_cast<std::uint8_t>(faceSecond.axis)};
+    return false;
+  }
+  EdgeQuery edges{queryEdges(first, second, delta)};
+  if (edges.separation > 0.0f) {
+    cache = AxisCache{AxisCache::Type::EDGES, static_cast<std::uint8_t>(edges.axisFirst), static_cast<std::uint8_t>(edges.axisSecond)};
+    return false;
+  }
+  cache = AxisCache{};
+
+  bool  isReferenceSecond{faceSecond.separation > FACE_RELATIVE_TOLERANCE * faceFirst.separation + FACE_ABSOLUTE_TOLERANCE};
+  float faceSeparation{isReferenceSecond ? faceSecond.separation : faceFirst.separation};
+  if (edges.separation > FACE_RELATIVE_TOLERANCE * faceSeparation + FACE_ABSOLUTE_TOLERANCE)
+    return collideEdges(first, second, edges, collisionInfo);
+
+  if (isReferenceSecond) {
+    ml::vec3 normal{second.axes[faceSecond.axis] * (delta.dot(second.axes[faceSecond.axis]) > 0.0f ? -1.0f : 1.0f)};
+    return collideFaces(second, faceSecond.axis, normal, first, true, collisionInfo);
+  }
+  ml::vec3 normal{first.axes[faceFirst.axis] * (delta.dot(first.axes[faceFirst.axis]) > 0.0f ? 1.0f : -1.0f)};
+  return collideFaces(first, faceFirst.axis, normal, second, false, collisionInfo);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+
+#include "CollisionInfo.hpp"
+#include "Shapes/Bounds.hpp"
+#include "Shapes/OBB.hpp"
+
+#include "Maths/Math.hpp"
+#include "Library.hpp"
+
+// Box in world space, the AABB and the OBB are both turned into one before the box/box narrowphase
+class Box final {
+public:
+  ml::vec3                center{0.0f, 0.0f, 0.0f};
+  std::array<ml::vec3, 3> axes{ml::vec3{1.0f, 0.0f, 0.0f}, ml::vec3{0.0f, 1.0f, 0.0f}, ml::vec3{0.0f, 0.0f, 1.0f}};  // unit length
+  ml::vec3                halfSizes{0.0f, 0.0f, 0.0f};
+
+public:
+  [[nodiscard]] DLLATTRIB static auto fromOBB(const OBB &box, const ml::mat4 &transform) noexcept -> Box;  // the scale of the transform goes in the half sizes
+  [[nodiscard]] DLLATTRIB static auto fromBounds(const Bounds &bounds) noexcept -> Box;
+
+  [[nodiscard]] inline auto getSupport(const ml::vec3 &direction) const noexcept -> ml::vec3 {  // the farthest corner in direction
+    ml::vec3 corner{center};
+    for (std::uint32_t i{0}; i < 3; ++i)
+      corner += axes[i] * (direction.dot(axes[i]) > 0.0f ? halfSizes[i] : -halfSizes[i]);
+    return corner;
+  }
+};
+
+// Separating axis test on the 15 axes of the two boxes, the faces are preferred to the edges when they are about as deep.
+// A face contact clips the incident face against the side planes of the reference face (Sutherland-Hodgman) and keeps
+// at most CollisionInfo::MAX_POINTS of the points below it, chosen to cover the largest area. An edge contact gives the
+// closest points of the two edges. The feature ids of the points are stable while the boxes keep touching the same way.
+// The axis that separated the boxes is kept in collisionInfo.features.axis and tested first at the next step.
+// Based on "Robust Contact Creation for Physics Simulations" by Dirk Gregorius, GDC 2015
+[[nodiscard]] DLLATTRIB bool collideBoxes(const Box &first, const Box &second, CollisionInfo &collisionInfo) noexcept;
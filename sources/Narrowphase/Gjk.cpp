@@ -0,0 +1,506 @@
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+
+#include "Gjk.hpp"
+
+namespace {
+  constexpr std::uint32_t MAX_GJK_ITERATIONS{32};
+  constexpr float         GJK_TOLERANCE{1.0e-4f};      // relative progress of the distance under which it has converged
+  constexpr float         OVERLAP_TOLERANCE{1.0e-8f};  // squared distance under which the cores are touching
+  constexpr float         DUPLICATE_TOLERANCE{1.0e-10f};
+  constexpr std::uint32_t MAX_EPA_ITERATIONS{32};
+  constexpr float         EPA_TOLERANCE{1.0e-4f};  // a new support point closer than that to the nearest face doesn't expand the polytope
+  constexpr std::size_t   MAX_EPA_VERTICES{MAX_EPA_ITERATIONS + 4};
+  constexpr std::size_t   MAX_EPA_FACES{128};
+  constexpr std::size_t   MAX_HORIZON_EDGES{64};
+  constexpr std::uint32_t MAX_CAST_ITERATIONS{32};
+
+  // point of the Minkowski difference first - second, with the points of the two cores giving it
+  class SupportPoint final {
+  public:
+    ml::vec3 point{0.0f, 0.0f, 0.0f};
+    ml::vec3 onFirst{0.0f, 0.0f, 0.0f};
+    ml::vec3 onSecond{0.0f, 0.0f, 0.0f};
+    ml::vec3 direction{0.0f, 0.0f, 0.0f};
+  };
+
+  class Simplex final {
+  public:
+    std::array<SupportPoint, 4> vertices{};
+    std::array<float, 4>        weights{};  // barycentric coordinates of the point of the simplex closest to the origin
+    std::uint32_t               count{0};
+  };
+
+  class Face final {
+  public:
+    std::array<std::uint32_t, 3> vertices{};
+    ml::vec3                     normal{0.0f, 0.0f, 0.0f};  // outward
+    float                        distance{0.0f};            // of the origin to the plane of the face
+  };
+
+  // core of a shape moved by offset, for the shape casts
+  class Translated final {
+  public:
+    const ConvexShape &shape;
+    ml::vec3           offset{0.0f, 0.0f, 0.0f};
+
+  public:
+    [[nodiscard]] inline auto getSupport(const ml::vec3 &direction) const -> ml::vec3 {
+      return shape.getSupport(direction) + offset;
+    }
+  };
+
+  auto support(const ConvexShape &first, const ConvexShape &second, const ml::vec3 &direction) -> SupportPoint {
+    SupportPoint vertex{};
+    vertex.direction = direction;
+    vertex.onFirst   = first.getSupport(direction);
+    vertex.onSecond  = second.getSupport(direction * -1.0f);
+    vertex.point     = vertex.onFirst - vertex.onSecond;
+    return vertex;
+  }
+
+  auto closestPoint(const Simplex &simplex) noexcept -> ml::vec3 {
+    ml::vec3 point{0.0f, 0.0f, 0.0f};
+    for (std::uint32_t i{0}; i < simplex.count; ++i)
+      point += simplex.vertices[i].point * simplex.weights[i];
+    return point;
+  }
+
+  auto makeSimplex(const SupportPoint &a) noexcept -> Simplex {
+    Simplex simplex{};
+    simplex.vertices[0] = a;
+    simplex.weights[0]  = 1.0f;
+    simplex.count       = 1;
+    return simplex;
+  }
+
+  auto makeSimplex(const SupportPoint &a, const SupportPoint &b, float t) noexcept -> Simplex {
+    Simplex simplex{};
+    simplex.vertices = {a, b};
+    simplex.weights  = {1.0f - t, t};
+    simplex.count    = 2;
+    return simplex;
+  }
+
+  auto solveSegment(const SupportPoint &a, const SupportPoint &b) noexcept -> Simplex {
+    ml::vec3 ab{b.point - a.point};
+    float    t{-a.point.dot(ab)};
+    if (t <= 0.0f)
+      return makeSimplex(a);
+    float length{ab.dot(ab)};
+    if (t >= length)
+      return makeSimplex(b);
+    return makeSimplex(a, b, t / length);
+  }
+
+  // the Voronoi regions of the vertices, then of the edges, then the face (Ericson 5.1.5)
+  auto solveTriangle(const SupportPoint &a, const SupportPoint &b, const SupportPoint &c) noexcept -> Simplex {
+    ml::vec3 ab{b.point - a.point};
+    ml::vec3 ac{c.point - a.point};
+    float    d1{-ab.dot(a.point)};
+    float    d2{-ac.dot(a.point)};
+    if (d1 <= 0.0f && d2 <= 0.0f)
+      return makeSimplex(a);
+
+    float d3{-ab.dot(b.point)};
+    float d4{-ac.dot(b.point)};
+    if (d3 >= 0.0f && d4 <= d3)
+      return makeSimplex(b);
+
+    float vc{d1 * d4 - d3 * d2};
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+      return makeSimplex(a, b, d1 / (d1 - d3));
+
+    float d5{-ab.dot(c.point)};
+    float d6{-ac.dot(c.point)};
+    if (d6 >= 0.0f && d5 <= d6)
+      return makeSimplex(c);
+
+    float vb{d5 * d2 - d1 * d6};
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+      return makeSimplex(a, c, d2 / (d2 - d6));
+
+    float va{d3 * d6 - d5 * d4};
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+      return makeSimplex(b, c, (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    float   denominator{1.0f / (va + vb + vc)};
+    float   v{vb * denominator};
+    float   w{vc * denominator};
+    Simplex simplex{};
+    simplex.vertices = {a, b, c};
+    simplex.weights  = {1.0f - v - w, v, w};
+    simplex.count    = 3;
+    return simplex;
+  }
+
+  // the origin is outside of the face pqr when the fourth vertex is on the other side of it, or when the tetrahedron is flat
+  bool isOutside(const ml::vec3 &p, const ml::vec3 &q, const ml::vec3 &r, const ml::vec3 &opposite) noexcept {
+    ml::vec3 normal{ml::vec3{q - p}.cross(r - p)};
+    float    originSide{-normal.dot(p)};
+    float    oppositeSide{normal.dot(opposite - p)};
+    return originSide * oppositeSide < 0.0f || oppositeSide == 0.0f;
+  }
+
+  // count stays 4 when the origin is inside the tetrahedron
+  auto solveTetrahedron(const Simplex &simplex) noexcept -> Simplex {
+    const SupportPoint &a{simplex.vertices[0]};
+    const SupportPoint &b{simplex.vertices[1]};
+    const SupportPoint &c{simplex.vertices[2]};
+    const SupportPoint &d{simplex.vertices[3]};
+    const std::array<std::array<const SupportPoint *, 4>, 4> faces{{{&a, &b, &c, &d}, {&a, &c, &d, &b}, {&a, &d, &b, &c}, {&b, &d, &c, &a}}};
+
+    Simplex best{simplex};
+    float   bestDistance{FLT_MAX};
+    for (const std::array<const SupportPoint *, 4> &face : faces) {
+      if (!isOutside(face[0]->point, face[1]->point, face[2]->point, face[3]->point))
+        continue;
+      Simplex  candidate{solveTriangle(*face[0], *face[1], *face[2])};
+      ml::vec3 point{closestPoint(candidate)};
+      if (float distance{point.dot(point)}; distance < bestDistance) {
+        bestDistance = distance;
+        best         = candidate;
+      }
+    }
+    return best;
+  }
+
+  auto solve(const Simplex &simplex) noexcept -> Simplex {
+    switch (simplex.count) {
+      case 1:
+        return makeSimplex(simplex.vertices[0]);
+      case 2:
+        return solveSegment(simplex.vertices[0], simplex.vertices[1]);
+      case 3:
+        return solveTriangle(simplex.vertices[0], simplex.vertices[1], simplex.vertices[2]);
+      default:
+        return solveTetrahedron(simplex);
+    }
+  }
+
+  bool contains(const Simplex &simplex, const SupportPoint &vertex) noexcept {
+    for (std::uint32_t i{0}; i < simplex.count; ++i) {
+      ml::vec3 offset{simplex.vertices[i].point - vertex.point};
+      if (offset.dot(offset) < DUPLICATE_TOLERANCE)
+        return true;
+    }
+    return false;
+  }
+
+  // Closest features of the two cores in simplex, false when they overlap
+  bool gjk(const ConvexShape &first, const ConvexShape &second, SimplexCache &cache, Simplex &simplex) {
+    simplex.count = 0;
+    for (std::uint32_t i{0}; i < cache.count; ++i) {
+      SupportPoint vertex{support(first, second, cache.directions[i])};
+      if (!contains(simplex, vertex))
+        simplex.vertices[simplex.count++] = vertex;
+    }
+    if (simplex.count == 0)
+      simplex.vertices[simplex.count++] = support(first, second, ml::vec3{1.0f, 0.0f, 0.0f});
+
+    bool isSeparated{true};
+    for (std::uint32_t iteration{0}; iteration < MAX_GJK_ITERATIONS; ++iteration) {
+      simplex = solve(simplex);
+      if (simplex.count == 4) {
+        isSeparated = false;
+        break;
+      }
+      ml::vec3 closest{closestPoint(simplex)};
+      float    distance{closest.dot(closest)};
+      if (distance < OVERLAP_TOLERANCE) {
+        isSeparated = false;
+        break;
+      }
+      // the support point doesn't get any closer to the origin: closest is on the boundary of the Minkowski difference
+      SupportPoint vertex{support(first, second, closest * -1.0f)};
+      if (distance - closest.dot(vertex.point) <= GJK_TOLERANCE * distance || contains(simplex, vertex) || iteration + 1 == MAX_GJK_ITERATIONS)
+        break;
+      simplex.vertices[simplex.count++] = vertex;
+    }
+
+    cache.count = simplex.count;
+    for (std::uint32_t i{0}; i < simplex.count; ++i)
+      cache.directions[i] = simplex.vertices[i].direction;
+    return isSeparated;
+  }
+
+  // The simplex of touching cores can miss dimensions, it is completed with the support points in the directions it lacks
+  bool makeTetrahedron(const ConvexShape &first, const ConvexShape &second, Simplex &simplex) {
+    static const std::array<ml::vec3, 6> AXES{ml::vec3{1.0f, 0.0f, 0.0f}, ml::vec3{-1.0f, 0.0f, 0.0f}, ml::vec3{0.0f, 1.0f, 0.0f}, ml::vec3{0.0f, -1.0f, 0.0f}, ml::vec3{0.0f, 0.0f, 1.0f}, ml::vec3{0.0f, 0.0f, -1.0f}};
+
+    auto tryAdd = [&](const ml::vec3 &direction, auto &&isIndependent) {
+      SupportPoint vertex{support(first, second, direction)};
+      if (!isIndependent(vertex.point))
+        return false;
+      simplex.vertices[simplex.count++] = vertex;
+      return true;
+    };
+
+    if (simplex.count == 1) {
+      for (const ml::vec3 &axis : AXES) {
+        if (tryAdd(axis, [&](const ml::vec3 &point) { return ml::vec3{point - simplex.vertices[0].point}.length() > EPA_TOLERANCE; }))
+          break;
+      }
+    }
+    if (simplex.count == 2) {
+      ml::vec3 line{simplex.vertices[1].point - simplex.vertices[0].point};
+      for (const ml::vec3 &axis : AXES) {
+        ml::vec3 direction{line.cross(axis)};
+        if (direction.dot(direction) < EPA_TOLERANCE)
+          continue;
+        if (tryAdd(direction, [&](const ml::vec3 &point) { return line.cross(point - simplex.vertices[0].point).length() > EPA_TOLERANCE; }))
+          break;
+      }
+    }
+    if (simplex.count == 3) {
+      ml::vec3 normal{ml::vec3{simplex.vertices[1].point - simplex.vertices[0].point}.cross(simplex.vertices[2].point - simplex.vertices[0].point)};
+      auto     isOffPlane = [&](const ml::vec3 &point) { return std::abs(normal.dot(point - simplex.vertices[0].point)) > EPA_TOLERANCE * normal.length(); };
+      if (!tryAdd(normal, isOffPlane))
+        (void)tryAdd(normal * -1.0f, isOffPlane);
+    }
+    return simplex.count == 4;
+  }
+
+  bool makeFace(const std::array<SupportPoint, MAX_EPA_VERTICES> &vertices, std::uint32_t a, std::uint32_t b, std::uint32_t c, Face &face) noexcept {
+    ml::vec3 normal{ml::vec3{vertices[b].point - vertices[a].point}.cross(vertices[c].point - vertices[a].point)};
+    float    length{normal.length()};
+    if (length < 1.0e-12f)
+      return false;
+    face.vertices = {a, b, c};
+    face.normal   = normal * (1.0f / length);
+    face.distance = face.normal.dot(vertices[a].point);
+    return true;
+  }
+
+  // Expand the tetrahedron around the origin towards the boundary of the Minkowski difference, in fixed size arrays
+  bool epa(const ConvexShape &first, const ConvexShape &second, const Simplex &tetrahedron, Face &nearest, std::array<SupportPoint, MAX_EPA_VERTICES> &vertices) {
+    std::array<Face, MAX_EPA_FACES>                                    faces{};
+    std::array<std::array<std::uint32_t, 2>, MAX_HORIZON_EDGES>        horizon{};
+    std::size_t                                                        faceCount{0};
+    std::uint32_t                                                      vertexCount{4};
+    const std::array<std::array<std::uint32_t, 4>, 4>                  TETRAHEDRON_FACES{{{0, 1, 2, 3}, {0, 3, 1, 2}, {0, 2, 3, 1}, {1, 3, 2, 0}}};
+
+    for (std::uint32_t i{0}; i < 4; ++i)
+      vertices[i] = tetrahedron.vertices[i];
+    for (const std::array<std::uint32_t, 4> &indices : TETRAHEDRON_FACES) {
+      // wind the faces so that their normal points away from the opposite vertex
+      std::uint32_t a{indices[0]};
+      std::uint32_t b{indices[1]};
+      std::uint32_t c{indices[2]};
+      ml::vec3      normal{ml::vec3{vertices[b].point - vertices[a].point}.cross(vertices[c].point - vertices[a].point)};
+      if (normal.dot(vertices[indices[3]].point - vertices[a].point) > 0.0f)
+        std::swap(b, c);
+      if (!makeFace(vertices, a, b, c, faces[faceCount]))
+        return false;
+      ++faceCount;
+    }
+
+    for (std::uint32_t iteration{0}; iteration < MAX_EPA_ITERATIONS; ++iteration) {
+      std::size_t closest{0};
+      for (std::size_t i{1}; i < faceCount; ++i) {
+        if (faces[i].distance < faces[closest].distance)
+          closest = i;
+      }
+      nearest = faces[closest];
+
+      SupportPoint vertex{support(first, second, nearest.normal)};
+      if (vertex.point.dot(nearest.normal) - nearest.distance < EPA_TOLERANCE || vertexCount == MAX_EPA_VERTICES)
+        return true;
+      std::uint32_t added{vertexCount++};
+      vertices[added] = vertex;
+
+      // remove the faces seen from the new vertex, the edges they don't share make the horizon
+      std::size_t edgeCount{0};
+      for (std::size_t i{0}; i < faceCount;) {
+        const Face &face{faces[i]};
+        if (face.normal.dot(vertex.point - vertices[face.vertices[0]].point) <= 0.0f) {
+          ++i;
+          continue;
+        }
+        for (std::uint32_t edge{0}; edge < 3; ++edge) {
+          std::array<std::uint32_t, 2> candidate{face.vertices[edge], face.vertices[(edge + 1) % 3]};
+          auto                         shared{std::find(horizon.begin(), horizon.begin() + edgeCount, std::array<std::uint32_t, 2>{candidate[1], candidate[0]})};
+          if (shared != horizon.begin() + edgeCount)
+            *shared = horizon[--edgeCount];
+          else if (edgeCount < MAX_HORIZON_EDGES)
+            horizon[edgeCount++] = candidate;
+          else
+            return true;
+        }
+        faces[i] = faces[--faceCount];
+      }
+
+      for (std::size_t i{0}; i < edgeCount; ++i) {
+        if (faceCount == MAX_EPA_FACES)
+          return true;
+        if (makeFace(vertices, horizon[i][0], horizon[i][1], added, faces[faceCount]))
+          ++faceCount;
+      }
+      if (faceCount == 0)
+        return false;
+    }
+    return true;
+  }
+
+  // end - start of a segment core, found along the world axis it projects the longest on. Null for a point
+  auto coreAxis(const ConvexShape &shape) -> ml::vec3 {
+    ml::vec3 longest{0.0f, 0.0f, 0.0f};
+    for (const ml::vec3 &axis : {ml::vec3{1.0f, 0.0f, 0.0f}, ml::vec3{0.0f, 1.0f, 0.0f}, ml::vec3{0.0f, 0.0f, 1.0f}}) {
+      ml::vec3 extent{shape.getSupport(axis) - shape.getSupport(axis * -1.0f)};
+      if (extent.dot(extent) > longest.dot(longest))
+        longest = extent;
+    }
+    return longest;
+  }
+
+  // middle of the two farthest points of the core along coreAxis, its center for segments and boxes
+  auto coreCenter(const ConvexShape &shape, const ml::vec3 &axis) -> ml::vec3 {
+    ml::vec3 direction{axis.dot(axis) > 0.0f ? axis : ml::vec3{1.0f, 0.0f, 0.0f}};
+    return (shape.getSupport(direction) + shape.getSupport(direction * -1.0f)) * 0.5f;
+  }
+
+  // normal of a contact whose cores overlap without volume between them (EPA can't run): the cross product of two
+  // crossing segments, else the offset between the cores or between their centers, orthogonal to the segments
+  auto flatNormal(const ConvexShape &first, const ConvexShape &second, const ml::vec3 &offset) -> ml::vec3 {
+    ml::vec3 axisFirst{coreAxis(first)};
+    ml::vec3 axisSecond{coreAxis(second)};
+    ml::vec3 centers{coreCenter(second, axisSecond) - coreCenter(first, axisFirst)};
+
+    ml::vec3 normal{axisFirst.cross(axisSecond)};
+    if (normal.dot(normal) > OVERLAP_TOLERANCE * axisFirst.dot(axisFirst) * axisSecond.dot(axisSecond))
+      return normal * (normal.dot(centers) < 0.0f ? -1.0f : 1.0f) * (1.0f / normal.length());
+    if (offset.dot(offset) > OVERLAP_TOLERANCE)
+      return offset * (1.0f / offset.length());
+
+    // the segments are parallel, or points: only the directions orthogonal to them separate the cores
+    ml::vec3 axis{axisFirst.dot(axisFirst) > axisSecond.dot(axisSecond) ? axisFirst : axisSecond};
+    float    axisLengthSq{axis.dot(axis)};
+    if (axisLengthSq > 0.0f)
+      centers -= axis * (centers.dot(axis) / axisLengthSq);
+    if (centers.dot(centers) > OVERLAP_TOLERANCE)
+      return centers * (1.0f / centers.length());
+    if (axisLengthSq == 0.0f)
+      return ml::vec3{0.0f, 1.0f, 0.0f};
+    // any direction orthogonal to the segment, from the world axis the least aligned with it
+    ml::vec3 world{std::fabs(axis.x) <= std::fabs(axis.y) && std::fabs(axis.x) <= std::fabs(axis.z) ? ml::vec3{1.0f, 0.0f, 0.0f}
+                   : std::fabs(axis.y) <= std::fabs(axis.z)                                       ? ml::vec3{0.0f, 1.0f, 0.0f}
+                                                                                                   : ml::vec3{0.0f, 0.0f, 1.0f}};
+    normal = axis.cross(world);
+    return normal * (1.0f / normal.length());
+  }
+}
+
+bool collideConvex(const ConvexShape &first, const ConvexShape &second, CollisionInfo &collisionInfo) noexcept {
+  float   radii{first.getRadius() + second.getRadius()};
+  Simplex simplex{};
+  if (gjk(first, second, collisionInfo.features.simplex, simplex)) {
+    // the cores are apart, the contact is between the closest points of their surfaces
+    ml::vec3 onFirst{0.0f, 0.0f, 0.0f};
+    ml::vec3 onSecond{0.0f, 0.0f, 0.0f};
+    for (std::uint32_t i{0}; i < simplex.count; ++i) {
+      onFirst += simplex.vertices[i].onFirst * simplex.weights[i];
+      onSecond += simplex.vertices[i].onSecond * simplex.weights[i];
+    }
+    ml::vec3 delta{onSecond - onFirst};
+    float    distance{delta.length()};
+    if (distance >= radii)
+      return false;
+    ml::vec3 normal{delta * (1.0f / distance)};
+    collisionInfo.addContactPoint(onFirst + normal * first.getRadius(), onSecond - normal * second.getRadius(), normal, radii - distance);
+    return true;
+  }
+
+  std::array<SupportPoint, MAX_EPA_VERTICES> vertices{};
+  Face                                       nearest{};
+  Simplex                                    touching{simplex};
+  if (!makeTetrahedron(first, second, simplex) || !epa(first, second, simplex, nearest, vertices)) {
+    // flat overlap, like two spheres with the same center or two crossing capsules, from where the cores touch
+    ml::vec3 onFirst{0.0f, 0.0f, 0.0f};
+    ml::vec3 onSecond{0.0f, 0.0f, 0.0f};
+    for (std::uint32_t i{0}; i < touching.count; ++i) {
+      onFirst += touching.vertices[i].onFirst * touching.weights[i];
+      onSecond += touching.vertices[i].onSecond * touching.weights[i];
+    }
+    ml::vec3 normal{flatNormal(first, second, onSecond - onFirst)};
+    collisionInfo.addContactPoint(onFirst + normal * first.getRadius(), onSecond - normal * second.getRadius(), normal, radii);
+    return true;
+  }
+
+  // barycentric coordinates of the projection of the origin on the nearest face give the points of the cores
+  const SupportPoint &a{vertices[nearest.vertices[0]]};
+  const SupportPoint &b{vertices[nearest.vertices[1]]};
+  const SupportPoint &c{vertices[nearest.vertices[2]]};
+  ml::vec3            ab{b.point - a.point};
+  ml::vec3            ac{c.point - a.point};
+  ml::vec3            ap{nearest.normal * nearest.distance - a.point};
+  float               d00{ab.dot(ab)};
+  float               d01{ab.dot(ac)};
+  float               d11{ac.dot(ac)};
+  float               d20{ap.dot(ab)};
+  float               d21{ap.dot(ac)};
+  float               denominator{d00 * d11 - d01 * d01};
+  float               v{denominator != 0.0f ? (d11 * d20 - d01 * d21) / denominator : 0.0f};
+  float               w{denominator != 0.0f ? (d00 * d21 - d01 * d20) / denominator : 0.0f};
+  float               u{1.0f - v - w};
+  ml::vec3            onFirst{a.onFirst * u + b.onFirst * v + c.onFirst * w};
+  ml::vec3            onSecond{a.onSecond * u + b.onSecond * v + c.onSecond * w};
+
+  // moving the second shape by the depth along the normal of the face separates the cores
+  const ml::vec3 &normal{nearest.normal};
+  collisionInfo.addContactPoint(onFirst + normal * first.getRadius(), onSecond - normal * second.getRadius(), normal, nearest.distance + radii);
+  return true;
+}
+
+bool overlapConvex(const ConvexShape &first, const ConvexShape &second) noexcept {
+  SimplexCache cache{};
+  Simplex      simplex{};
+  if (!gjk(first, second, cache, simplex))
+    return true;
+  float radii{first.getRadius() + second.getRadius()};
+  return closestPoint(simplex).dot(closestPoint(simplex)) <= radii * radii;
+}
+
+bool castConvex(const ConvexShape &first, const ml::vec3 &displacement, const ConvexShape &second, float tolerance, float maxFraction, ConvexCast &cast) noexcept {
+  float        radii{first.getRadius() + second.getRadius()};
+  SimplexCache cache{};  // the moved shape stays close to the last one, its simplex starts the next query
+  cast = ConvexCast{};
+  for (std::uint32_t iteration{0}; iteration < MAX_CAST_ITERATIONS; ++iteration) {
+    Translated moved{first, displacement * cast.fraction};
+    Simplex    simplex{};
+    if (!gjk(ConvexShape{moved, first.getRadius()}, second, cache, simplex)) {
+      // the advancement stops before the cores can meet: they overlap from the start
+      cast.point         = moved.getSupport(displacement);
+      cast.isOverlapping = true;
+      return true;
+    }
+
+    ml::vec3 onFirst{0.0f, 0.0f, 0.0f};
+    ml::vec3 onSecond{0.0f, 0.0f, 0.0f};
+    for (std::uint32_t i{0}; i < simplex.count; ++i) {
+      onFirst += simplex.vertices[i].onFirst * simplex.weights[i];
+      onSecond += simplex.vertices[i].onSecond * simplex.weights[i];
+    }
+    ml::vec3 delta{onFirst - onSecond};
+    float    coreDistance{delta.length()};
+    cast.normal        = delta * (1.0f / coreDistance);
+    cast.point         = onSecond + cast.normal * second.getRadius();
+    cast.isOverlapping = coreDistance < radii;
+
+    // the distance is a convex function of the fraction, its slope is -approach: moving along or away from the second
+    // shape never brings them closer, and the distance can't shrink faster than that
+    float approach{-displacement.dot(cast.normal)};
+    if (approach <= 0.0f)
+      return false;
+
+    // gjk stops once a support point doesn't get closer than GJK_TOLERANCE of the distance, the exact one is at most that much shorter
+    float distance{coreDistance * (1.0f - GJK_TOLERANCE) - radii};
+    if (distance <= tolerance)
+      return true;
+    cast.fraction += distance / approach;
+    if (cast.fraction > maxFraction)
+      return false;
+  }
+  return false;  // didn't converge, no contact was reached
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <type_traits>
+
+#include "CollisionInfo.hpp"
+
+#include "Maths/Math.hpp"
+#include "Library.hpp"
+
+// Segment in world space, a point when both ends are the same: the core of the spheres and of the capsules
+class Segment final {
+public:
+  ml::vec3 start{0.0f, 0.0f, 0.0f};
+  ml::vec3 end{0.0f, 0.0f, 0.0f};
+
+public:
+  [[nodiscard]] inline auto getSupport(const ml::vec3 &direction) const noexcept -> ml::vec3 {
+    return direction.dot(end - start) > 0.0f ? end : start;
+  }
+};
+
+// Convex shape seen through its support function (the farthest point in a direction) in world space, rounded by a radius.
+// It references the core, which must outlive it: nothing is copied nor allocated.
+class ConvexShape final {
+public:
+  template <class Core>
+    requires(!std::is_same_v<std::decay_t<Core>, ConvexShape>)
+  explicit ConvexShape(const Core &core, float radius = 0.0f) noexcept
+      : m_core{&core}, m_support{[](const void *shape, const ml::vec3 &direction) -> ml::vec3 { return static_cast<const Core *>(shape)->getSupport(direction); }}, m_radius{radius} {}
+
+  [[nodiscard]] inline auto getSupport(const ml::vec3 &direction) const -> ml::vec3 {  // of the core
+    return m_support(m_core, direction);
+  }
+
+  [[nodiscard]] inline auto getRadius() const noexcept -> float {
+    return m_radius;
+  }
+
+private:
+  const void *m_core{nullptr};
+  ml::vec3 (*m_support)(const void *, const ml::vec3 &){nullptr};
+  float m_radius{0.0f};
+};
+
+// Contact of two convex shapes, one point along the shortest way out.
+// GJK finds the distance between the two cores, which is enough while it is above 0: the radii are removed from it.
+// The cores only overlap on deep contacts, EPA then expands the last GJK simplex to the face of the Minkowski difference
+// nearest to the origin. The query starts from collisionInfo.features.simplex and leaves its last simplex there for the next step.
+// Based on "Collision Detection in Interactive 3D Environments" by Gino van den Bergen, and "Real-Time Collision Detection"
+// by Christer Ericson for the closest points of the simplices
+[[nodiscard]] DLLATTRIB bool collideConvex(const ConvexShape &first, const ConvexShape &second, CollisionInfo &collisionInfo) noexcept;
+
+// True when the two shapes touch or overlap, GJK alone answers it
+[[nodiscard]] DLLATTRIB bool overlapConvex(const ConvexShape &first, const ConvexShape &second) noexcept;
+
+// First contact of a convex shape moved along a displacement with another one
+class ConvexCast final {
+public:
+  float    fraction{0.0f};            // of the displacement done before the contact, the time of impact
+  ml::vec3 point{0.0f, 0.0f, 0.0f};   // on the surface of the shape hit
+  ml::vec3 normal{0.0f, 0.0f, 0.0f};  // of the shape hit, towards the moving one. Null when their cores overlap
+  bool     isOverlapping{false};      // the shapes already overlap before moving, at fraction 0
+};
+
+// Conservative advancement: the first shape can move until the displacement along the normal between the closest points
+// covers their distance (given by GJK, which never overestimates it) without touching it. The contact is found once the
+// shapes are closer than tolerance and the displacement still closes on the second one, a shape touching it while moving
+// along or away from it doesn't hit it. False when the first shape moves further than maxFraction of the displacement
+// without hitting the second one, which doesn't move. Based on "Continuous Collision Detection and Physical Simulation"
+// by Brian Mirtich
+[[nodiscard]] DLLATTRIB bool castConvex(const ConvexShape &first, const ml::vec3 &displacement, const ConvexShape &second, float tolerance, float maxFraction, ConvexCast &cast) noexcept;
@@ -0,0 +1,126 @@
+#include <stdexcept>
+#include <utility>
+
+#include "PairCache.hpp"
+
+template <class Entry>
+auto PairTable<Entry>::hash(std::uint64_t key) const noexcept -> std::size_t {
+  std::uint64_t h{key * 0x9E3779B97F4A7C15ull};
+  return static_cast<std::size_t>(h ^ (h >> 29)) & (m_slots.size() - 1);
+}
+
+template <class Entry>
+auto PairTable<Entry>::findSlot(std::uint64_t key) const noexcept -> std::size_t {
+  std::size_t mask{m_slots.size() - 1};
+  std::size_t slot{hash(key)};
+  while (m_slots[slot] != EMPTY_SLOT && m_keys[m_slots[slot]] != key)
+    slot = (slot + 1) & mask;
+  return slot;
+}
+
+template <class Entry>
+auto PairTable<Entry>::find(BodyHandle first, BodyHandle second) noexcept -> Entry * {
+  return const_cast<Entry *>(std::as_const(*this).find(first, second));
+}
+
+template <class Entry>
+auto PairTable<Entry>::find(BodyHandle first, BodyHandle second) const noexcept -> const Entry * {
+  if (m_entries.empty())
+    return nullptr;
+  std::size_t slot{findSlot(makeKey(first, second))};
+  return m_slots[slot] == EMPTY_SLOT ? nullptr : &m_entries[m_slots[slot]];
+}
+
+template <class Entry>
+auto PairTable<Entry>::insert(const Entry &entry) -> Entry & {
+  if ((m_entries.size() + 1) * 2 > m_slots.size())
+    grow();
+
+  std::uint64_t key{makeKey(entry.firstCollider, entry.secondCollider)};
+  std::size_t   slot{findSlot(key)};
+  if (m_slots[slot] != EMPTY_SLOT) {
+    m_entries[m_slots[slot]] = entry;
+    return m_entries[m_slots[slot]];
+  }
+
+  m_slots[slot] = static_cast<std::uint32_t>(m_entries.size());
+  m_entries.push_back(entry);
+  m_keys.push_back(key);
+  return m_entries.back();
+}
+
+template <class Entry>
+void PairTable<Entry>::eraseSlot(std::size_t slot) {
+  std::size_t mask{m_slots.size() - 1};
+  std::size_t hole{slot};
+  std::size_t next{slot};
+  while (true) {
+    next = (next + 1) & mask;
+    if (m_slots[next] == EMPTY_SLOT)
+      break;
+    // an entry can only fill the hole if its ideal slot is not between the hole and itself
+    std::size_t ideal{hash(m_keys[m_slots[next]])};
+    bool        stayInPlace{hole <= next ? (hole < ideal && ideal <= next) : (hole < ideal || ideal <= next)};
+    if (stayInPlace)
+      continue;
+    m_slots[hole] = m_slots[next];
+    hole          = next;
+  }
+  m_slots[hole] = EMPTY_SLOT;
+}
+
+template <class Entry>
+void PairTable<Entry>::removeAt(std::size_t index) {
+  eraseSlot(findSlot(m_keys[index]));
+
+  std::size_t last{m_entries.size() - 1};
+  if (index != last) {
+    m_entries[index]                 = m_entries[last];
+    m_keys[index]                    = m_keys[last];
+    m_slots[findSlot(m_keys[index])] = static_cast<std::uint32_t>(index);
+  }
+  m_entries.pop_back();
+  m_keys.pop_back();
+}
+
+template <class Entry>
+void PairTable<Entry>::removeBody(BodyHandle handle) {
+  for (std::size_t i{0}; i < m_entries.size();) {
+    if (m_entries[i].firstCollider == handle || m_entries[i].secondCollider == handle)
+      removeAt(i);
+    else
+      ++i;
+  }
+}
+
+template <class Entry>
+void PairTable<Entry>::clear() noexcept {
+  m_entries.clear();
+  m_keys.clear();
+  std::fill(m_slots.begin(), m_slots.end(), EMPTY_SLOT);
+}
+
+template <class Entry>
+void PairTable<Entry>::grow() {
+  m_slots.assign(std::max<std::size_t>(16, m_slots.size() * 2), EMPTY_SLOT);
+  for (std::size_t i{0}; i < m_keys.size(); ++i)
+    m_slots[findSlot(m_keys[i])] = static_cast<std::uint32_t>(i);
+}
+
+template <class Entry>
+auto PairTable<Entry>::size() const noexcept -> std::size_t {
+  return m_entries.size();
+}
+
+template <class Entry>
+auto PairTable<Entry>::operator[](std::size_t index) -> Entry & {
+  return m_entries[index];
+}
+
+template <class Entry>
+auto PairTable<Entry>::operator[](std::size_t index) const -> const Entry & {
+  return m_entries[index];
+}
+
+template class PairTable<CollisionInfo>;
+template class PairTable<PairFeatures>;
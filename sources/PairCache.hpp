@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CollisionInfo.hpp"
+#include "Library.hpp"
+
+// Persistent table of entries of pairs of bodies (Entry has a firstCollider and a secondCollider), keyed on the
+// (min, max) handles of the two bodies.
+// Entries are stored densely and indexed by an open addressing hash table (linear probing, backward shift deletion),
+// so a lookup is O(1) and a pair keeps the same slot from one frame to the next until it expires.
+// Removing swaps the last entry in the freed slot.
+// Instantiated in PairCache.cpp for the entries of the PhysicsSystem
+template <class Entry>
+class PairTable final {
+public:
+  DLLATTRIB explicit PairTable() = default;
+
+  [[nodiscard]] DLLATTRIB auto find(BodyHandle first, BodyHandle second) noexcept -> Entry *;  // nullptr when the pair is unknown
+  [[nodiscard]] DLLATTRIB auto find(BodyHandle first, BodyHandle second) const noexcept -> const Entry *;
+  DLLATTRIB auto               insert(const Entry &entry) -> Entry &;  // Replace the entry if the pair is already known
+  DLLATTRIB void               removeAt(std::size_t index);           // The last entry is moved to index
+  DLLATTRIB void               removeBody(BodyHandle handle);
+  DLLATTRIB void               clear() noexcept;
+
+  [[nodiscard]] DLLATTRIB auto size() const noexcept -> std::size_t;
+  [[nodiscard]] DLLATTRIB auto operator[](std::size_t index) -> Entry &;
+  [[nodiscard]] DLLATTRIB auto operator[](std::size_t index) const -> const Entry &;
+
+  [[nodiscard]] inline auto begin() noexcept {
+    return m_entries.begin();
+  }
+
+  [[nodiscard]] inline auto end() noexcept {
+    return m_entries.end();
+  }
+
+  [[nodiscard]] static inline std::uint64_t makeKey(BodyHandle first, BodyHandle second) noexcept {
+    if (first > second)
+      std::swap(first, second);
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(first)) << 32) | static_cast<std::uint32_t>(second);
+  }
+
+private:
+  static constexpr std::uint32_t EMPTY_SLOT{UINT32_MAX};
+
+  [[nodiscard]] auto findSlot(std::uint64_t key) const noexcept -> std::size_t;  // slot holding key, or the empty slot ending its probe
+  [[nodiscard]] auto hash(std::uint64_t key) const noexcept -> std::size_t;
+  void               eraseSlot(std::size_t slot);
+  void               grow();
+
+  std::vector<Entry>         m_entries{};
+  std::vector<std::uint64_t> m_keys{};   // key of each entry
+  std::vector<std::uint32_t> m_slots{};  // hash table of indices in m_entries, size is a power of two
+};
+
+using PairCache = PairTable<CollisionInfo>;  // the touching pairs
@@ -1,3 +1,5 @@
+#include <stdexcept>
+
 #include "PhysicsObject.hpp"
 
 ml::vec3 PhysicsObject::getLinearVelocity() const {
@@ -32,6 +34,22 @@ bool PhysicsObject::getIsRigid() const {
   return m_isRigid;
 }
 
+void PhysicsObject::setIsContinuous(bool isContinuous) {
+  m_isContinuous = isContinuous;
+}
+
+bool PhysicsObject::getIsContinuous() const {
+  return m_isContinuous;
+}
+
+float PhysicsObject::getElasticity() const {
+  return m_elasticity;
+}
+
+float PhysicsObject::getFriction() const {
+  return m_friction;
+}
+
 void PhysicsObject::setLinearVelocity(const ml::vec3 &v) {
   m_linearVelocity = v;
 }
@@ -44,13 +62,19 @@ Matrix<float, 3, 3> PhysicsObject::getInertiaTensor() {
   return m_inverseInteriaTensor;
 }
 
-PhysicsObject::PhysicsObject(std::unique_ptr<ICollisionShape> shape) : m_shape{std::move(shape)} {
+ml::vec3 PhysicsObject::getInverseInertia() const {
+  return inverseInertia;
+}
+
+PhysicsObject::PhysicsObject(CollisionShape shape) : m_shape{std::move(shape)} {
   m_inverseMass = 1.0f;
   m_elasticity  = 0.8f;
   m_friction    = 0.8f;
   m_isRigid     = false;
 }
 
+PhysicsObject::PhysicsObject(std::unique_ptr<ICollisionShape> shape) : PhysicsObject{shape ? makeCollisionShape(*shape) : throw std::invalid_argument{"PhysicsObject needs a collision shape"}} {}
+
 void PhysicsObject::applyAngularImpulse(const ml::vec3 &force) {
   m_angularVelocity += m_inverseInteriaTensor * force;
 }
@@ -4,13 +4,14 @@
 #include <array>
 
 #include "ICollisionShape.hpp"
+#include "CollisionShape.hpp"
 #include "Maths/Math.hpp"
 #include "Maths/Quaternion.hpp"
 #include "Library.hpp"
 
 class PhysicsObject final {
 public:
-  std::unique_ptr<ICollisionShape> m_shape{nullptr};
+  CollisionShape m_shape;
 
 private:
   const float UNIT_MULTIPLIER = 100.0f;
@@ -20,7 +21,8 @@ private:
   float m_elasticity  = 0.8f;
   float m_friction    = 0.8f;
 
-  bool m_isRigid = false;
+  bool m_isRigid      = false;
+  bool m_isContinuous = false;
 
   // linear stuff
   ml::vec3 m_linearVelocity{0.0f, 0.0f, 0.0f};
@@ -29,7 +31,7 @@ private:
   // angular stuff
   ml::vec3            m_angularVelocity{0.0f, 0.0f, 0.0f};
   ml::vec3            m_torque{0.0f, 0.0f, 0.0f};
-  ml::vec3            inverseInertia{0.0f, 0.0f, 0.0f};
+  ml::vec3            inverseInertia{1.0f, 1.0f, 1.0f};
   Matrix<float, 3, 3> m_inverseInteriaTensor{std::array<std::array<float, 3>, 3>{
   std::array<float, 3>{1.0f, 0.0f, 0.0f},
   std::array<float, 3>{0.0f, 1.0f, 0.0f},
@@ -37,7 +39,8 @@ private:
   }};
 
 public:
-  DLLATTRIB explicit PhysicsObject(std::unique_ptr<ICollisionShape> shape);
+  DLLATTRIB explicit PhysicsObject(CollisionShape shape);
+  DLLATTRIB explicit PhysicsObject(std::unique_ptr<ICollisionShape> shape);  // the shape is copied in a CollisionShape, throw std::invalid_argument if null
 
   DLLATTRIB void clearForces() noexcept;
 
@@ -53,6 +56,12 @@ public:
   DLLATTRIB void setIsRigid(bool isRigid);
   DLLATTRIB bool getIsRigid() const;
 
+  DLLATTRIB void setIsContinuous(bool isContinuous);  // for the small and fast bodies, see PhysicsSystem::setContinuous
+  DLLATTRIB bool getIsContinuous() const;
+
+  DLLATTRIB float getElasticity() const;
+  DLLATTRIB float getFriction() const;
+
   DLLATTRIB void applyAngularImpulse(const ml::vec3 &force);
   DLLATTRIB void applyLinearImpulse(const ml::vec3 &force);
 
@@ -69,4 +78,5 @@ public:
   DLLATTRIB void initSphereInertia();
 
   DLLATTRIB Matrix<float, 3, 3> getInertiaTensor();
+  DLLATTRIB ml::vec3            getInverseInertia() const;
 };
@@ -1,218 +1,142 @@
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
 #include "PhysicsSystem.hpp"
+#include "Narrowphase/BoxBox.hpp"
+#include "Narrowphase/Gjk.hpp"
+
+namespace {
+  // the GJK narrowphase works on the rounded cores of the shapes
+  auto sphereCore(const Sphere &sphere, const ml::mat4 &matrix) noexcept -> Segment {
+    ml::vec3 center{sphere.getPoints(matrix)};
+    return Segment{center, center};
+  }
+
+  // the ends of a capsule are the tips of its caps
+  auto capsuleCore(const Capsule &capsule, const ml::mat4 &matrix) -> Segment {
+    std::array<ml::vec3, 2> points{matrix * capsule.getStart(), matrix * capsule.getEnd()};
+    ml::vec3                axis{points.front() - points.back()};
+    axis.normalize();
+    return Segment{points.back() + axis * capsule.getRadius(), points.front() - axis * capsule.getRadius()};
+  }
+
+  // the AABB and the OBB go through the box/box narrowphase and the GJK as a Box
+  auto boxOf(const CollisionShape &shape, const ml::mat4 &matrix) noexcept -> Box {
+    if (const OBB *obb{std::get_if<OBB>(&shape)}; obb != nullptr)
+      return Box::fromOBB(*obb, matrix);
+    return Box::fromBounds(std::get<AABB>(shape).getBounds(matrix));
+  }
+
+  // sphere inside the shape: a body moving by less than its radius during a step can't go through another one
+  class InnerSphere final {
+  public:
+    ml::vec3 center{0.0f, 0.0f, 0.0f};
+    float    radius{0.0f};
+  };
+
+  auto innerSphere(CollisionShape &shape, const ml::mat4 &matrix) -> InnerSphere {
+    if (const Sphere *sphere{std::get_if<Sphere>(&shape)}; sphere != nullptr)
+      return InnerSphere{sphere->getPoints(matrix), sphere->getRadius()};
+    if (const Capsule *capsule{std::get_if<Capsule>(&shape)}; capsule != nullptr) {
+      Segment core{capsuleCore(*capsule, matrix)};
+      return InnerSphere{(core.start + core.end) * 0.5f, capsule->getRadius()};
+    }
+    Box box{boxOf(shape, matrix)};
+    return InnerSphere{box.center, std::min({box.halfSizes.x, box.halfSizes.y, box.halfSizes.z})};
+  }
+
+  // the octant of the direction then its quantized coordinates: sorting on it puts the rays going the same way together
+  auto directionKey(const ml::vec3 &direction) noexcept -> std::uint32_t {
+    auto          quantize{[](float coordinate) { return static_cast<std::uint32_t>(std::clamp(coordinate * 0.5f + 0.5f, 0.0f, 1.0f) * 511.0f); }};
+    std::uint32_t octant{(direction.x < 0.0f ? 4u : 0u) | (direction.y < 0.0f ? 2u : 0u) | (direction.z < 0.0f ? 1u : 0u)};
+    return octant << 27 | quantize(direction.x) << 18 | quantize(direction.y) << 9 | quantize(direction.z);
+  }
+
+  // function(const ConvexShape &) with the shape in world space, its core lives on the stack during the call
+  template <class Function>
+  auto withConvexShape(const CollisionShape &shape, const ml::mat4 &matrix, Function &&function) {
+    if (const Sphere *sphere{std::get_if<Sphere>(&shape)}; sphere != nullptr) {
+      Segment core{sphereCore(*sphere, matrix)};
+      return function(ConvexShape{core, sphere->getRadius()});
+    }
+    if (const Capsule *capsule{std::get_if<Capsule>(&shape)}; capsule != nullptr) {
+      Segment core{capsuleCore(*capsule, matrix)};
+      return function(ConvexShape{core, capsule->getRadius()});
+    }
+    Box box{boxOf(shape, matrix)};
+    return function(ConvexShape{box});
+  }
+}
 
-void CollisionInfo::addContactPoint(const ml::vec3 &localA, const ml::vec3 &localB, const ml::vec3 &normal, float p) {
-  point.localA      = localA;
-  point.localB      = localB;
+void CollisionInfo::addContactPoint(const ml::vec3 &onA, const ml::vec3 &onB, const ml::vec3 &normal, float p, std::uint32_t featureId) {
+  if (pointCount == MAX_POINTS)
+    return;
+  ContactPoint &point{points[pointCount++]};
+  point.onA         = onA;
+  point.onB         = onB;
   point.normal      = normal;
   point.penetration = p;
+  point.featureId   = featureId;
 }
 
 bool PhysicsSystem::collide(AABB &firstCollider, const ml::mat4 &modelMatrixFirstCollider, AABB &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept {
   Log logger{"PhysicsSystem"};
   // logger.Debug("Check collisions AABB/AABB");
-  auto     firstPoints       = firstCollider.getPoints(modelMatrixFirstCollider, true);
-  auto     secondPoints      = secondCollider.getPoints(modelMatrixSecondCollider, true);
-  ml::vec3 minFirstCollider  = firstPoints.front();
-  ml::vec3 maxFirstCollider  = firstPoints.back();
-  ml::vec3 minSecondCollider = secondPoints.front();
-  ml::vec3 maxSecondCollider = secondPoints.back();
-
-  if (maxFirstCollider.x > minSecondCollider.x && minFirstCollider.x < maxSecondCollider.x && maxFirstCollider.y > minSecondCollider.y && minFirstCollider.y < maxSecondCollider.y && maxFirstCollider.z > minSecondCollider.z && minFirstCollider.z < maxSecondCollider.z) {
-    static const ml::vec3 faces[6] = {
-    ml::vec3(-1, 0, 0),
-    ml::vec3(1, 0, 0),
-    ml::vec3(0, -1, 0),
-    ml::vec3(0, 1, 0),
-    ml::vec3(0, 0, -1),
-    ml::vec3(0, 0, 1),
-    };
-
-    float distances[6] = {
-    (maxSecondCollider.x - minFirstCollider.x),  // distance of box ’b’ to ’left ’ of ’a ’.
-    (maxFirstCollider.x - minSecondCollider.x),  // distance of box ’b’ to ’right ’ of ’a ’.
-    (maxSecondCollider.y - minFirstCollider.y),  // distance of box ’b’ to ’bottom ’ of ’a ’.
-    (maxFirstCollider.y - minSecondCollider.y),  // distance of box ’b’ to ’top ’ of ’a ’.
-    (maxSecondCollider.z - minFirstCollider.z),  // distance of box ’b’ to ’far ’ of ’a ’.
-    (maxFirstCollider.z - minSecondCollider.z)   // distance of box ’b’ to ’near ’ of ’a ’.
-    };
-    float    penetration = FLT_MAX;
-    ml::vec3 bestAxis(0.0f, 0.0f, 0.0f);
-
-    for (int i = 0; i < 6; i++) {
-      if (distances[i] < penetration) {
-        penetration = distances[i];
-        bestAxis    = faces[i];
-      }
-    }
-    // std::cout << "Collide AABB/AABB with penetration = " << penetration << std::endl;
-    collisionInfo.addContactPoint(ml::vec3(0.0f, 0.0f, 0.0f), ml::vec3(0.0f, 0.0f, 0.0f), bestAxis, penetration);
-    // logger.Debug("AABB/AABB collided with a normal vector : {{0}, {1}, {2}} and a penetration of {3}", bestAxis.x, bestAxis.y, bestAxis.z, penetration);
-    return true;
-  }
-  // logger.Debug("AABB/AABB didn't collide");
-  return false;
+  return collideBoxes(Box::fromBounds(firstCollider.getBounds(modelMatrixFirstCollider)), Box::fromBounds(secondCollider.getBounds(modelMatrixSecondCollider)), collisionInfo);
 }
 
 bool PhysicsSystem::collide(const Sphere &firstCollider, const ml::mat4 &modelMatrixFirstCollider, const Sphere &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept {
   Log logger{"PhysicsSystem"};
   // logger.Debug("Check collisions Sphere/Sphere");
-  auto     firstCenter  = firstCollider.getPoints(modelMatrixFirstCollider);
-  auto     secondCenter = secondCollider.getPoints(modelMatrixSecondCollider);
-  float    radii        = firstCollider.getRadius() + secondCollider.getRadius();
-  ml::vec3 delta        = secondCenter - firstCenter;
-
-  float deltaLength = delta.length();
-  if (deltaLength < radii) {
-    float penetration = (radii - deltaLength);
-    delta.normalize();
-    ml::vec3 normal = delta;
-    ml::vec3 localA = normal * firstCollider.getRadius();
-    ml::vec3 localB = (normal * -1) * secondCollider.getRadius();
-    collisionInfo.addContactPoint(localA, localB, normal, penetration);
-    // logger.Debug("Sphere/Sphere collided with a normal vector : {{0}, {1}, {2}} and a penetration of {3}", normal.x, normal.y, normal.z, penetration);
-    return true;
-  }
-  // logger.Debug("Sphere/Sphere didn't collide");
-  return false;
+  Segment firstCore{sphereCore(firstCollider, modelMatrixFirstCollider)};
+  Segment secondCore{sphereCore(secondCollider, modelMatrixSecondCollider)};
+  return collideConvex(ConvexShape{firstCore, firstCollider.getRadius()}, ConvexShape{secondCore, secondCollider.getRadius()}, collisionInfo);
 }
 
 bool PhysicsSystem::collide(AABB &firstCollider, const ml::mat4 &modelMatrixFirstCollider, const Sphere &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept {
   Log logger{"PhysicsSystem"};
   // logger.Debug("Check collisions AABB/Sphere");
-  auto     firstPoints       = firstCollider.getPoints(modelMatrixFirstCollider);
-  auto     secondCenter      = secondCollider.getPoints(modelMatrixSecondCollider);
-  ml::vec3 minFirstCollider  = firstPoints.front();
-  ml::vec3 maxFirstCollider  = firstPoints.back();
-  ml::vec3 boxHalfSize       = (maxFirstCollider - minFirstCollider) * 0.5f;
-  ml::vec3 delta             = secondCenter - ((maxFirstCollider + minFirstCollider) * 0.5f);
-  ml::vec3 closestPointOnBox = delta.clamp((boxHalfSize * -1), boxHalfSize);
-  ml::vec3 localPoint        = delta - closestPointOnBox;
-  float    distance          = localPoint.length();
-  if (distance < secondCollider.getRadius()) {
-    localPoint.normalize();
-    ml::vec3 collisionNormal = localPoint;
-    float    penetration     = (secondCollider.getRadius() - distance);
-    ml::vec3 localA          = ml::vec3(0.0f, 0.0f, 0.0f);
-    ml::vec3 localB          = (collisionNormal * -1) * secondCollider.getRadius();
-    collisionInfo.addContactPoint(localA, localB, collisionNormal, penetration);
-    // logger.Debug("AABB/Sphere collided with a normal vector : {{0}, {1}, {2}} and a penetration of {3}", collisionNormal.x, collisionNormal.y, collisionNormal.z, penetration);
-    return true;
-  }
-  // logger.Debug("AABB/Sphere didn't collide");
-  return false;
+  Box     box{Box::fromBounds(firstCollider.getBounds(modelMatrixFirstCollider))};
+  Segment core{sphereCore(secondCollider, modelMatrixSecondCollider)};
+  return collideConvex(ConvexShape{box}, ConvexShape{core, secondCollider.getRadius()}, collisionInfo);
 }
 
-// Returns right hand perpendicular vector
-ml::vec3 getNormal(const ml::vec3 &v) {
-  return ml::vec3(-v.y, v.x, v.z);
-}
-
-bool isMinkowskiFace(ml::vec3 edgeAFaceANormal, ml::vec3 edgeAFaceBNormal, ml::vec3 edgeADirection, ml::vec3 edgeBFaceANormal, ml::vec3 edgeBFaceBNormal, ml::vec3 edgeBDirection) {
-  ml::vec3 edgeACross = edgeAFaceBNormal.cross(edgeAFaceANormal);
-  ml::vec3 edgeBCross = edgeBFaceBNormal.cross(edgeBFaceANormal);
-
-  float edgeBFaceADirection = edgeBFaceANormal.dot(edgeACross);
-  float edgeBFaceBDirection = edgeBFaceBNormal.dot(edgeACross);
-  float edgeAFaceADirection = edgeAFaceANormal.dot(edgeBCross);
-  float edgeAFaceBDirection = edgeAFaceBNormal.dot(edgeBCross);
-
-  return ((edgeBFaceADirection * edgeBFaceBDirection < 0) && (edgeAFaceADirection * edgeAFaceBDirection < 0) && (edgeBFaceADirection * edgeAFaceBDirection > 0));
-}
-
-bool queryEdgeCollisions(OBB &reference, OBB &incident, CollisionInfo &results) {
-  auto edgesA = reference.m_edges;
-  auto edgesB = reference.m_edges;
-  for (int i = 0; i < edgesA.size(); i++) {
-    auto     referenceFaceA   = reference.m_faces[std::get<OBB::FACES>(edgesA[i])[0]];
-    auto     referenceFaceB   = reference.m_faces[std::get<OBB::FACES>(edgesA[i])[1]];
-    ml::vec3 edgeAFaceANormal = std::get<OBB::NORMAL>(referenceFaceA);
-    ml::vec3 edgeAFaceBNormal = std::get<OBB::NORMAL>(referenceFaceB);
-    for (int j = 0; j < edgesB.size(); j++) {
-      auto     incidentFaceA    = incident.m_faces[std::get<OBB::FACES>(edgesB[j])[0]];
-      ml::vec3 edgeBFaceANormal = std::get<OBB::NORMAL>(incidentFaceA);
-      edgeBFaceANormal *= -1;
-      auto     incidentFaceB    = incident.m_faces[std::get<OBB::FACES>(edgesB[j])[1]];
-      ml::vec3 edgeBFaceBNormal = std::get<OBB::NORMAL>(incidentFaceB);
-      edgeBFaceBNormal *= -1;
-      // COULD BE WRONG : (B - A) * transform == (B * transform - A * transform)
-      ml::vec3 edgeADirection = std::get<OBB::EDGES>(edgesA[i])[1] - std::get<OBB::EDGES>(edgesA[i])[0];  // edgesA.get(i).getTransformedDirection(reference.getWorldTransform()).normalize();
-      edgeADirection.normalize();
-      ml::vec3 edgeBDirection = std::get<OBB::EDGES>(edgesA[j])[1] - std::get<OBB::EDGES>(edgesA[j])[0];  // edgesB.get(j).getTransformedDirection(incident.getWorldTransform()).normalize();
-      edgeBDirection.normalize();
-
-      if (isMinkowskiFace(edgeAFaceANormal, edgeAFaceBNormal, edgeADirection, edgeBFaceANormal, edgeBFaceBNormal, edgeBDirection)) {
-        ml::vec3 axis = edgeADirection.cross(edgeBDirection);
-        if (axis.length() == 0) {
-          continue;
-        }
-        axis.normalize();
-        ml::vec3 transformedPointA = std::get<OBB::EDGES>(edgesA[i])[0];
-        ml::vec3 transformedPointB = std::get<OBB::EDGES>(edgesB[i])[0];
-
-        if (axis.dot(transformedPointA - ((reference.m_pointsCache[reference.m_pointsCache.size() - 1] + reference.m_pointsCache[0]) * 0.5f)) < 0) {
-          axis *= -1;
-        }
-
-        float distance = axis.dot(transformedPointB - transformedPointA);
-        if (distance > 0) {
-          return false;
-        }
-        if (distance > results.point.penetration) {
-          results.addContactPoint(ml::vec3(0.0f, 0.0f, 0.0f), ml::vec3(0.0f, 0.0f, 0.0f), axis, distance);
-        }
-      }
-    }
-  }
-  return true;
+bool PhysicsSystem::collide(OBB &firstCollider, const ml::mat4 &modelMatrixFirstCollider, OBB &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept {
+  Log logger{"PhysicsSystem"};
+  // logger.Debug("Check collisions OBB/OBB");
+  return collideBoxes(Box::fromOBB(firstCollider, modelMatrixFirstCollider), Box::fromOBB(secondCollider, modelMatrixSecondCollider), collisionInfo);
 }
 
-bool queryFaceCollisions(OBB &reference, OBB &incident, CollisionInfo &results) {
-  for (int i = 0; i < reference.m_faces.size(); i++) {
-    ml::vec3 axis       = std::get<OBB::NORMAL>(reference.m_faces[i]);
-    ml::vec3 planePoint = reference.getSupport(axis);
-    float    distance   = axis.dot(planePoint);
-
-    ml::vec3 negatedNormal = axis * -1.0f;
-    ml::vec3 support       = incident.getSupport(negatedNormal);
-
-    distance = axis.dot(planePoint) - distance;
-    if (distance > 0) {
-      return false;
-    }
-    if (distance > results.point.penetration) {
-      results.addContactPoint(ml::vec3(0.0f, 0.0f, 0.0f), ml::vec3(0.0f, 0.0f, 0.0f), axis, distance);
-    }
-  }
-  return true;
+bool PhysicsSystem::collide(OBB &firstCollider, const ml::mat4 &modelMatrixFirstCollider, const Sphere &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept {
+  Log logger{"PhysicsSystem"};
+  // logger.Debug("Check collisions OBB/Sphere");
+  Box     box{Box::fromOBB(firstCollider, modelMatrixFirstCollider)};
+  Segment core{sphereCore(secondCollider, modelMatrixSecondCollider)};
+  return collideConvex(ConvexShape{box}, ConvexShape{core, secondCollider.getRadius()}, collisionInfo);
 }
 
-bool PhysicsSystem::collide(OBB &firstCollider, const ml::mat4 &modelMatrixFirstCollider, OBB &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept {
-  auto firstPoints  = firstCollider.getPoints(modelMatrixFirstCollider, true);
-  auto secondPoints = secondCollider.getPoints(modelMatrixSecondCollider, true);
-  if (!queryFaceCollisions(firstCollider, secondCollider, collisionInfo)) {
-    return true;
-  }
-  if (!queryFaceCollisions(secondCollider, firstCollider, collisionInfo)) {
-    return true;
-  }
-  if (!queryEdgeCollisions(secondCollider, firstCollider, collisionInfo)) {
-    return true;
-  }
-  return false;
+bool PhysicsSystem::collide(OBB &firstCollider, const ml::mat4 &modelMatrixFirstCollider, AABB &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept {
+  // an AABB is a box without rotation around its world bounds
+  return collideBoxes(Box::fromOBB(firstCollider, modelMatrixFirstCollider), Box::fromBounds(secondCollider.getBounds(modelMatrixSecondCollider)), collisionInfo);
 }
 
-auto PhysicsSystem::getEntityWorldPositionAABB(const ICollisionShape &shape, const ml::mat4 &matrix) -> ml::vec3 {
-  return matrix.getTranslation() * shape.getLocalPosition();
+bool PhysicsSystem::collide(OBB &firstCollider, const ml::mat4 &modelMatrixFirstCollider, Capsule &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept {
+  Log logger{"PhysicsSystem"};
+  // logger.Debug("Check collisions OBB/Capsule");
+  Box     box{Box::fromOBB(firstCollider, modelMatrixFirstCollider)};
+  Segment core{capsuleCore(secondCollider, modelMatrixSecondCollider)};
+  return collideConvex(ConvexShape{box}, ConvexShape{core, secondCollider.getRadius()}, collisionInfo);
 }
 
+
 auto PhysicsSystem::getEntityWorldPosition(const ICollisionShape &shape, const ml::mat4 &matrix) -> ml::vec3 {
   return matrix * shape.getLocalPosition();
 }
 
-bool PhysicsSystem::checkCollisionExists(CollisionInfo existedOne, CollisionInfo toCompare) {
-  if ((existedOne.firstCollider == toCompare.firstCollider && existedOne.secondCollider == toCompare.secondCollider) || (existedOne.firstCollider == toCompare.secondCollider && existedOne.secondCollider == toCompare.firstCollider))
-    return true;
-  return false;
+auto PhysicsSystem::getWorldBounds(const CollisionShape &shape, const ml::mat4 &matrix) -> Bounds {
+  return std::visit([&matrix](const auto &concrete) { return concrete.getBounds(matrix); }, shape);
 }
 
 auto PhysicsSystem::closestPointOnLineSegment(ml::vec3 A, ml::vec3 B, ml::vec3 Point) -> ml::vec3 {
@@ -226,364 +150,598 @@ auto PhysicsSystem::closestPointOnLineSegment(ml::vec3 A, ml::vec3 B, ml::vec3 P
 bool PhysicsSystem::collide(Capsule &firstCollider, const ml::mat4 &modelMatrixFirstCollider, Capsule &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept {
   Log logger{"PhysicsSystem"};
   // logger.Debug("Check collisions Capsule/Capsule");
-  std::vector<ml::vec3> pointsFirstCollider{firstCollider.getPoints(modelMatrixFirstCollider)};
-  std::vector<ml::vec3> pointsSecondCollider{secondCollider.getPoints(modelMatrixSecondCollider)};
-  ml::vec3              a_Normal = pointsFirstCollider.front() - pointsFirstCollider.back();
-  a_Normal.normalize();
-  ml::vec3 a_LineEndOffset = a_Normal * firstCollider.getRadius();
-  ml::vec3 a_A             = pointsFirstCollider.back() + a_LineEndOffset;
-  ml::vec3 a_B             = pointsFirstCollider.front() - a_LineEndOffset;
-
-  // capsule B:
-  ml::vec3 b_Normal = pointsSecondCollider.front() - pointsSecondCollider.back();
-  b_Normal.normalize();
-  ml::vec3 b_LineEndOffset = b_Normal * secondCollider.getRadius();
-  ml::vec3 b_A             = pointsSecondCollider.back() + b_LineEndOffset;
-  ml::vec3 b_B             = pointsSecondCollider.front() - b_LineEndOffset;
-
-  // vectors between line endpoints:
-  ml::vec3 v0 = b_A - a_A;
-  ml::vec3 v1 = b_B - a_A;
-  ml::vec3 v2 = b_A - a_B;
-  ml::vec3 v3 = b_B - a_B;
-
-  // squared distances:
-  float d0 = v0.dot(v0);
-  float d1 = v1.dot(v1);
-  float d2 = v2.dot(v2);
-  float d3 = v3.dot(v3);
-
-  // select best potential endpoint on capsule A:
-  ml::vec3 bestA{0.0f, 0.0f, 0.0f};
-  if (d2 < d0 || d2 < d1 || d3 < d0 || d3 < d1) {
-    bestA = a_B;
-  } else {
-    bestA = a_A;
-  }
-
-  ml::vec3 bestB = PhysicsSystem::closestPointOnLineSegment(b_A, b_B, bestA);
-
-  bestA                       = PhysicsSystem::closestPointOnLineSegment(a_A, a_B, bestB);
-  ml::vec3 penetration_normal = bestA - bestB;
-  float    len                = penetration_normal.length();
-  penetration_normal.normalize();
-  float penetration_depth = firstCollider.getRadius() + secondCollider.getRadius() - len;
-  if (penetration_depth > 0) {
-    ml::vec3 collisionNormal = penetration_normal * -1.0f;
-    float    penetration     = penetration_depth;
-    ml::vec3 localA          = ml::vec3(0.0f, 0.0f, 0.0f);
-    ml::vec3 localB          = ml::vec3(0.0f, 0.0f, 0.0f);
-    collisionInfo.addContactPoint(localA, localB, collisionNormal, penetration);
-    // logger.Debug("Capsule/Capsule collided with a normal vector : {{0}, {1}, {2}} and a penetration of {3}", collisionNormal.x, collisionNormal.y, collisionNormal.z, penetration);
-    return true;
-  }
-  // logger.Debug("Capsule/Capsule didn't collide");
-  return false;
+  Segment firstCore{capsuleCore(firstCollider, modelMatrixFirstCollider)};
+  Segment secondCore{capsuleCore(secondCollider, modelMatrixSecondCollider)};
+  return collideConvex(ConvexShape{firstCore, firstCollider.getRadius()}, ConvexShape{secondCore, secondCollider.getRadius()}, collisionInfo);
 }
 
 bool PhysicsSystem::collide(Capsule &firstCollider, const ml::mat4 &modelMatrixFirstCollider, const Sphere &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept {
   Log logger{"PhysicsSystem"};
   // logger.Debug("Check collisions Capsule/Sphere");
-  std::vector<ml::vec3> pointsFirstCollider{firstCollider.getPoints(modelMatrixFirstCollider)};
-  auto                  secondCenter{secondCollider.getPoints(modelMatrixSecondCollider)};
-
-  ml::vec3 a_Normal = pointsFirstCollider.front() - pointsFirstCollider.back();
-  a_Normal.normalize();
-  ml::vec3 a_LineEndOffset = a_Normal * firstCollider.getRadius();
-  ml::vec3 a_A             = pointsFirstCollider.back() + a_LineEndOffset;
-  ml::vec3 a_B             = pointsFirstCollider.front() - a_LineEndOffset;
-  ml::vec3 bestA           = PhysicsSystem::closestPointOnLineSegment(a_A, a_B, secondCenter);
-
-  const ml::mat4 matrix{
-  {
-  {1.0f, 0.0f, 0.0f, 0.0f},
-  {0.0f, 1.0f, 0.0f, 0.0f},
-  {0.0f, 0.0f, 1.0f, 0.0f},
-  {0.0f, 0.0f, 0.0f, 1.0f},
-  },
-  };
-  // logger.Debug("Send collision to Sphere/Sphere");
-  return (collide(Sphere(bestA, firstCollider.getRadius()), matrix, Sphere(secondCenter, secondCollider.getRadius()), matrix, collisionInfo));
+  Segment firstCore{capsuleCore(firstCollider, modelMatrixFirstCollider)};
+  Segment secondCore{sphereCore(secondCollider, modelMatrixSecondCollider)};
+  return collideConvex(ConvexShape{firstCore, firstCollider.getRadius()}, ConvexShape{secondCore, secondCollider.getRadius()}, collisionInfo);
 }
 
-bool PhysicsSystem::collide(AABB &secondCollider, const ml::mat4 &modelMatrixSecondCollider, Capsule &firstCollider, const ml::mat4 &modelMatrixFirstCollider, CollisionInfo &collisionInfo) noexcept {
+bool PhysicsSystem::collide(AABB &firstCollider, const ml::mat4 &modelMatrixFirstCollider, Capsule &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept {
   Log logger{"PhysicsSystem"};
   // logger.Debug("Check collisions AABB/Capsule");
-  std::vector<ml::vec3> pointsFirstCollider{firstCollider.getPoints(modelMatrixFirstCollider)};
-  auto                  secondPoints{secondCollider.getPoints(modelMatrixSecondCollider)};
-  auto                  secondCenter = PhysicsSystem::getEntityWorldPosition(secondCollider, modelMatrixSecondCollider);
-  ml::vec3              a_Normal     = pointsFirstCollider.front() - pointsFirstCollider.back();
-  a_Normal.normalize();
-  ml::vec3       a_LineEndOffset = a_Normal * firstCollider.getRadius();
-  ml::vec3       a_A             = pointsFirstCollider.back() + a_LineEndOffset;
-  ml::vec3       a_B             = pointsFirstCollider.front() - a_LineEndOffset;
-  ml::vec3       bestA           = PhysicsSystem::closestPointOnLineSegment(a_A, a_B, secondCenter);
-  const ml::mat4 matrix{
-  {
-  {1.0f, 0.0f, 0.0f, 0.0f},
-  {0.0f, 1.0f, 0.0f, 0.0f},
-  {0.0f, 0.0f, 1.0f, 0.0f},
-  {0.0f, 0.0f, 0.0f, 1.0f},
-  },
-  };
-  AABB aabb{AABB(secondPoints.front(), secondPoints.back())};
-  // logger.Debug("Send collision to AABB/Sphere");
-  return (collide(aabb, matrix, Sphere(bestA, firstCollider.getRadius()), matrix, collisionInfo));
+  Box     box{Box::fromBounds(firstCollider.getBounds(modelMatrixFirstCollider))};
+  Segment core{capsuleCore(secondCollider, modelMatrixSecondCollider)};
+  return collideConvex(ConvexShape{box}, ConvexShape{core, secondCollider.getRadius()}, collisionInfo);
 }
 
-void PhysicsSystem::collisionDections() {
-  /* FIX : auto &entities{getItems()};
-  for (auto i = entities.begin(); i != entities.end(); i++) {
-    for (auto j = i + 1; j != entities.end(); j++) {
-      auto &&[entityI, physicsI, transformI]{*i};
-      auto &&[entityJ, physicsJ, transformJ]{*j};
-      // m_logger.Debug("Testing collision with {0}, and {1}", entityI, entityJ);
-      if (entityI == entityJ) {
-        // m_logger.Debug("Skip collisions because objects are equals.");
-        continue;
-      }
+// Call the narrowphase of a couple of shapes, pairs only implemented in the other order are swapped and their contact flipped
+template <class First, class Second>
+bool PhysicsSystem::collidePair(CollisionShape &first, const ml::mat4 &firstMatrix, CollisionShape &second, const ml::mat4 &secondMatrix, CollisionInfo &collisionInfo) {
+  First & firstCollider{*std::get_if<First>(&first)};
+  Second &secondCollider{*std::get_if<Second>(&second)};
+  if constexpr (requires { PhysicsSystem::collide(firstCollider, firstMatrix, secondCollider, secondMatrix, collisionInfo); }) {
+    return PhysicsSystem::collide(firstCollider, firstMatrix, secondCollider, secondMatrix, collisionInfo);
+  } else {
+    static_assert(requires { PhysicsSystem::collide(secondCollider, secondMatrix, firstCollider, firstMatrix, collisionInfo); }, "missing narrowphase for a couple of CollisionShape");
+    collisionInfo.features.flip();
+    bool isColliding{PhysicsSystem::collide(secondCollider, secondMatrix, firstCollider, firstMatrix, collisionInfo)};
+    collisionInfo.features.flip();
+    if (!isColliding)
+      return false;
+    for (ContactPoint &point : collisionInfo.getPoints()) {
+      std::swap(point.onA, point.onB);
+      point.normal *= -1.0f;
+    }
+    return true;
+  }
+}
 
-      CollisionInfo info{
-      .firstCollider  = entityI,
-      .secondCollider = entityJ,
-      };
+template <class Shape>
+bool PhysicsSystem::raycastShape(const Ray &r, const ml::mat4 &worldTransform, CollisionShape &shape, RayCollision &collision) {
+  Shape &volume{*std::get_if<Shape>(&shape)};
+  if constexpr (std::is_same_v<Shape, AABB>)
+    return RayAABBIntersection(r, worldTransform, volume, collision);
+  else if constexpr (std::is_same_v<Shape, OBB>)
+    return RayOBBIntersection(r, worldTransform, volume, collision);
+  else if constexpr (std::is_same_v<Shape, Sphere>)
+    return RaySphereIntersection(r, worldTransform, volume, collision);
+  else if constexpr (std::is_same_v<Shape, Capsule>)
+    return RayCapsuleIntersection(r, worldTransform, volume, collision);
+  else
+    static_assert(!sizeof(Shape), "missing ray intersection for a CollisionShape");
+}
 
-      auto it = std::find_if(m_collisions.begin(), m_collisions.end(), [this, info](CollisionInfo toCompare) {
-        return checkCollisionExists(info, toCompare);
-      });
+template <std::size_t Row, std::size_t... Columns>
+constexpr auto PhysicsSystem::makeNarrowphaseRow(std::index_sequence<Columns...>) -> std::array<NarrowphaseEntry, SHAPE_COUNT> {
+  using First = std::variant_alternative_t<Row, CollisionShape>;
 
-      if (it != m_collisions.end()) {
-        // m_logger.Debug("Skip collisions because a resolution is already active with this two colliders.");
-        continue;
-      }
-
-      if (physicsI.m_shape->m_shapeType == ShapeType::AABB && physicsJ.m_shape->m_shapeType == ShapeType::AABB) {
-        if (collide(reinterpret_cast<AABB &>(*physicsI.m_shape), transformI.matrix, reinterpret_cast<AABB &>(*physicsJ.m_shape), transformJ.matrix, info) == true)
-          m_collisions.push_back(info);
-      } else if (physicsI.m_shape->m_shapeType == ShapeType::SPHERE && physicsJ.m_shape->m_shapeType == ShapeType::SPHERE) {
-        if (collide(reinterpret_cast<Sphere &>(*physicsI.m_shape), transformI.matrix, reinterpret_cast<Sphere &>(*physicsJ.m_shape), transformJ.matrix, info) == true)
-          m_collisions.push_back(info);
-      } else if (physicsI.m_shape->m_shapeType == ShapeType::AABB && physicsJ.m_shape->m_shapeType == ShapeType::SPHERE) {
-        if (collide(reinterpret_cast<AABB &>(*physicsI.m_shape), transformI.matrix, reinterpret_cast<Sphere &>(*physicsJ.m_shape), transformJ.matrix, info) == true)
-          m_collisions.push_back(info);
-      } else if (physicsI.m_shape->m_shapeType == ShapeType::SPHERE && physicsJ.m_shape->m_shapeType == ShapeType::AABB) {
-        if (collide(reinterpret_cast<AABB &>(*physicsJ.m_shape), transformJ.matrix, reinterpret_cast<Sphere &>(*physicsI.m_shape), transformI.matrix, info) == true) {
-          // std::cout << "in here" << std::endl;
-          info.firstCollider  = entityJ;
-          info.secondCollider = entityI;
-          m_collisions.push_back(info);
-        }
-      } else if (physicsI.m_shape->m_shapeType == ShapeType::CAPSULE && physicsJ.m_shape->m_shapeType == ShapeType::CAPSULE) {
-        if (collide(reinterpret_cast<Capsule &>(*physicsI.m_shape), transformI.matrix, reinterpret_cast<Capsule &>(*physicsJ.m_shape), transformJ.matrix, info) == true)
-          m_collisions.push_back(info);
-      } else if (physicsI.m_shape->m_shapeType == ShapeType::CAPSULE && physicsJ.m_shape->m_shapeType == ShapeType::SPHERE) {
-        if (collide(reinterpret_cast<Capsule &>(*physicsI.m_shape), transformI.matrix, reinterpret_cast<Sphere &>(*physicsJ.m_shape), transformJ.matrix, info) == true)
-          m_collisions.push_back(info);
-      } else if (physicsI.m_shape->m_shapeType == ShapeType::SPHERE && physicsJ.m_shape->m_shapeType == ShapeType::CAPSULE) {
-        if (collide(reinterpret_cast<Capsule &>(*physicsJ.m_shape), transformJ.matrix, reinterpret_cast<Sphere &>(*physicsI.m_shape), transformI.matrix, info) == true) {
-          info.firstCollider  = entityJ;
-          info.secondCollider = entityI;
-          m_collisions.push_back(info);
-        }
-      } else if (physicsI.m_shape->m_shapeType == ShapeType::CAPSULE && physicsJ.m_shape->m_shapeType == ShapeType::AABB) {
-        if (collide(reinterpret_cast<AABB &>(*physicsJ.m_shape), transformJ.matrix, reinterpret_cast<Capsule &>(*physicsI.m_shape), transformI.matrix, info) == true) {
-          info.firstCollider  = entityJ;
-          info.secondCollider = entityI;
-          m_collisions.push_back(info);
-        }
-      } else if (physicsI.m_shape->m_shapeType == ShapeType::AABB && physicsJ.m_shape->m_shapeType == ShapeType::CAPSULE) {
-        if (collide(reinterpret_cast<AABB &>(*physicsI.m_shape), transformI.matrix, reinterpret_cast<Capsule &>(*physicsJ.m_shape), transformJ.matrix, info) == true)
-          m_collisions.push_back(info);
-      } else if (physicsI.m_shape->m_shapeType == ShapeType::OBB && physicsJ.m_shape->m_shapeType == ShapeType::OBB) {
-        if (collide(reinterpret_cast<OBB &>(*physicsJ.m_shape), transformJ.matrix, reinterpret_cast<OBB &>(*physicsI.m_shape), transformI.matrix, info) == true)
-          m_collisions.push_back(info);
-      }
-    }
-  }*/
+  return {NarrowphaseEntry{
+  &PhysicsSystem::collidePair<First, std::variant_alternative_t<Columns, CollisionShape>>,
+  }...};
 }
 
-void PhysicsSystem::collisionResolution() {
-  for (auto i{m_collisions.begin()}; i != m_collisions.end();) {
-    if (i->framesLeft == 2) {
-      if (m_callbackCollision) {
-        m_callbackCollision(i->firstCollider, i->secondCollider);
-      }
-      impulseResolveCollision(*i);
-    }
-    i->framesLeft = i->framesLeft - 1;
-    if (i->framesLeft < 0) {
-      i = m_collisions.erase(i);
-    } else
-      ++i;
-  }
+template <std::size_t... Rows>
+constexpr auto PhysicsSystem::makeNarrowphaseTable(std::index_sequence<Rows...>) -> std::array<std::array<NarrowphaseEntry, SHAPE_COUNT>, SHAPE_COUNT> {
+  return {makeNarrowphaseRow<Rows>(std::make_index_sequence<SHAPE_COUNT>{})...};
 }
 
-void PhysicsSystem::impulseResolveCollision(CollisionInfo &p) const {
-  // m_logger.Debug("Resolve collisions between {0} and {1}", p.firstCollider, p.secondCollider);
-  /* FIX : auto &&[physA, transformA]{m_admin.getComponents<Components::Physics, Components::Transform>(p.firstCollider)};
-  auto &&[physB, transformB]{m_admin.getComponents<Components::Physics, Components::Transform>(p.secondCollider)};
+template <std::size_t... Shapes>
+constexpr auto PhysicsSystem::makeRaycastTable(std::index_sequence<Shapes...>) -> std::array<RayFunction, SHAPE_COUNT> {
+  return {&PhysicsSystem::raycastShape<std::variant_alternative_t<Shapes, CollisionShape>>...};
+}
 
-  float totalMass = physA.getInverseMass() + physB.getInverseMass();
+constexpr std::array<std::array<PhysicsSystem::NarrowphaseEntry, PhysicsSystem::SHAPE_COUNT>, PhysicsSystem::SHAPE_COUNT> PhysicsSystem::NARROWPHASE_TABLE{makeNarrowphaseTable(std::make_index_sequence<SHAPE_COUNT>{})};
+constexpr std::array<PhysicsSystem::RayFunction, PhysicsSystem::SHAPE_COUNT>                                             PhysicsSystem::RAYCAST_TABLE{makeRaycastTable(std::make_index_sequence<SHAPE_COUNT>{})};
 
-  // Separate them out using projection
-  if (!physA.getIsRigid()) {
-    transformA.matrix.setTranslation(transformA.matrix.getTranslation() - (p.point.normal * p.point.penetration * (physA.getInverseMass() / totalMass)));
-  }
-  if (!physB.getIsRigid()) {
-    transformB.matrix.setTranslation(transformB.matrix.getTranslation() + (p.point.normal * p.point.penetration * (physB.getInverseMass() / totalMass)));
-  }
+bool PhysicsSystem::collide(std::size_t first, std::size_t second, CollisionInfo &info) {
+  CollisionShape &shapeI{m_bodies.shapes[first]};
+  CollisionShape &shapeJ{m_bodies.shapes[second]};
+  return NARROWPHASE_TABLE[shapeI.index()][shapeJ.index()].collide(shapeI, m_bodies.transforms[first].matrix, shapeJ, m_bodies.transforms[second].matrix, info);
+}
 
-  ml::vec3 relativeA{p.point.localA - getEntityWorldPosition(*physA.m_shape.get(), transformA.matrix)};
-  ml::vec3 relativeB{p.point.localB - getEntityWorldPosition(*physB.m_shape.get(), transformB.matrix)};
+void PhysicsSystem::updateBroadphase() {
+  m_worldBounds.resize(m_bodies.size());
+  m_scheduler->parallelFor(m_bodies.size(), BODY_GRAIN, [this](std::size_t begin, std::size_t end) {
+    for (std::size_t i{begin}; i < end; ++i) {
+      if (isActive(i))
+        m_worldBounds[i] = getWorldBounds(m_bodies.shapes[i], m_bodies.transforms[i].matrix);
+    }
+  });
+
+  // the tree and the sweep and prune are updated in place, on this thread
+  for (std::size_t i{0}; i < m_bodies.size(); ++i) {
+    if (!isActive(i))
+      continue;
+    BodyHandle    handle{m_bodies.handleOf(i)};
+    const Bounds &bounds{m_worldBounds[i]};
+    m_tree.move(handle, bounds, bounds.getCenter() - m_tree.getBounds(handle).getCenter());
+    if (m_broadphaseType == BroadphaseType::SWEEP_AND_PRUNE)
+      m_sweepAndPrune.update(handle, bounds);
+  }
+}
 
-  auto shapeA{(*physA.m_shape.get()).m_shapeType};
-  auto shapeB{(*physB.m_shape.get()).m_shapeType};
-  bool shouldDo{false};
-  // AABB
-  shouldDo = shouldDo || (shapeA == ShapeType::AABB && shapeB == ShapeType::AABB);
+void PhysicsSystem::findBroadphasePairs() {
+  m_pairs.clear();
+  if (m_broadphaseType == BroadphaseType::SWEEP_AND_PRUNE) {
+    m_sweepAndPrune.findPairs(m_pairs);
+    return;
+  }
 
-  // Sphere
-  shouldDo = shouldDo || (shapeA == ShapeType::SPHERE && shapeB == ShapeType::SPHERE);
+  // every chunk of nodes queries the tree on its own, the pairs keep the order of a single threaded search
+  std::size_t nodeCount{m_tree.getNodeCount()};
+  m_pairChunks.resize((nodeCount + NODE_GRAIN - 1) / NODE_GRAIN);
+  m_scheduler->parallelFor(nodeCount, NODE_GRAIN, [this](std::size_t begin, std::size_t end) {
+    std::vector<BroadphasePair> &pairs{m_pairChunks[begin / NODE_GRAIN]};
+    pairs.clear();
+    m_tree.findPairs(begin, end, pairs);
+  });
+  for (const std::vector<BroadphasePair> &pairs : m_pairChunks)
+    m_pairs.insert(m_pairs.end(), pairs.begin(), pairs.end());
+}
 
-  // AABB / Sphere
-  shouldDo = shouldDo || (shapeA == ShapeType::AABB && shapeB == ShapeType::SPHERE);
-  shouldDo = shouldDo || (shapeA == ShapeType::SPHERE && shapeB == ShapeType::AABB);
+void PhysicsSystem::collisionDections() {
+  updateBroadphase();
+  findBroadphasePairs();
+
+  // every pair gets its entry in the feature cache before the narrowphase, the workers then update them in place
+  for (const BroadphasePair &pair : m_pairs) {
+    PairFeatures *entry{m_features.find(pair.first, pair.second)};
+    if (entry == nullptr)
+      entry = &m_features.insert(PairFeatures{.firstCollider = pair.first, .secondCollider = pair.second});
+    entry->isTested = true;
+  }
 
-  // AABB / Capsule
-  shouldDo = shouldDo || (shapeA == ShapeType::AABB && shapeB == ShapeType::CAPSULE);
-  shouldDo = shouldDo || (shapeA == ShapeType::CAPSULE && shapeB == ShapeType::AABB);
+  // every worker appends to its own buffer, the order of the pairs in a buffer depends on the scheduling
+  for (const std::unique_ptr<Arena> &arena : m_workerArenas)
+    m_workerContacts.emplace_back(arena.get());
+  m_scheduler->parallelFor(m_pairs.size(), PAIR_GRAIN, [this](std::size_t begin, std::size_t end) {
+    std::pmr::vector<CollisionInfo> &contacts{m_workerContacts[m_scheduler->getCurrentWorker()]};
+    for (std::size_t i{begin}; i < end; ++i) {
+      const BroadphasePair &pair{m_pairs[i]};
+      // m_logger.Debug("Testing collision with {0}, and {1}", pair.first, pair.second);
+      CollisionInfo info{
+      .firstCollider  = pair.first,
+      .secondCollider = pair.second,
+      .isTouching     = true,
+      };
+      // the query starts from what the last one found, a pair is in a single chunk so its entry has a single writer
+      PairFeatures &entry{*m_features.find(pair.first, pair.second)};
+      bool          isFlipped{entry.firstCollider != pair.first};
+      info.features = entry.features;
+      if (isFlipped)
+        info.features.flip();
+      bool isColliding{collide(m_bodies.indexOf(pair.first), m_bodies.indexOf(pair.second), info)};
+      entry.features = info.features;
+      if (isFlipped)
+        entry.features.flip();
+      if (isColliding)
+        contacts.push_back(info);
+    }
+  });
+
+  // the pairs that left the broadphase forget their features
+  for (std::size_t i{0}; i < m_features.size();) {
+    if (!m_features[i].isTested) {
+      m_features.removeAt(i);
+    } else {
+      m_features[i].isTested = false;
+      ++i;
+    }
+  }
 
-  if (shouldDo) {
-    relativeA = p.point.localA - getEntityWorldPositionAABB(*physA.m_shape.get(), transformA.matrix);
-    relativeB = p.point.localB - getEntityWorldPositionAABB(*physB.m_shape.get(), transformB.matrix);
+  // a pair is found once, sorting on its key gives the same contacts in the same order whatever the thread count
+  std::pmr::vector<CollisionInfo> contacts{&m_stepArena};
+  for (const std::pmr::vector<CollisionInfo> &workerContacts : m_workerContacts)
+    contacts.insert(contacts.end(), workerContacts.begin(), workerContacts.end());
+  m_workerContacts.clear();
+  std::sort(contacts.begin(), contacts.end(), [](const CollisionInfo &a, const CollisionInfo &b) {
+    return PairCache::makeKey(a.firstCollider, a.secondCollider) < PairCache::makeKey(b.firstCollider, b.secondCollider);
+  });
+
+  // the sleeping bodies are static in the broadphase: their contacts aren't detected again and are kept as they are
+  for (CollisionInfo &collision : m_collisions)
+    collision.isTouching = !isActive(m_bodies.indexOf(collision.firstCollider)) && !isActive(m_bodies.indexOf(collision.secondCollider));
+
+  for (CollisionInfo &info : contacts) {
+    // a pair that was already touching keeps its impulses to warm start the solver
+    if (CollisionInfo *previous{m_collisions.find(info.firstCollider, info.secondCollider)}; previous != nullptr) {
+      ContactSolver::warmStartFrom(*previous, info);
+      info.touchingSteps = previous->touchingSteps + 1;
+    }
+    m_collisions.insert(info);
   }
 
-  ml::vec3 angVelocityA{physA.getAngularVelocity().cross(relativeA)};
-  ml::vec3 angVelocityB{physB.getAngularVelocity().cross(relativeB)};
+  for (std::size_t i{0}; i < m_collisions.size();) {
+    if (!m_collisions[i].isTouching)
+      m_collisions.removeAt(i);  // the last collision is moved to i, process it next
+    else
+      ++i;
+  }
+}
 
-  ml::vec3 fullVelocityA{physA.getLinearVelocity() + angVelocityA};
-  ml::vec3 fullVelocityB{physB.getLinearVelocity() + angVelocityB};
-  ml::vec3 contactVelocity{fullVelocityB - fullVelocityA};
+void PhysicsSystem::buildIslands() {
+  m_islands.reset(m_bodies.size());
+  for (const CollisionInfo &collision : m_collisions) {
+    std::size_t a{m_bodies.indexOf(collision.firstCollider)};
+    std::size_t b{m_bodies.indexOf(collision.secondCollider)};
+    if (!m_bodies.rigids[a] && !m_bodies.rigids[b])
+      m_islands.link(a, b);
+  }
+  m_islands.build(m_bodies, m_stepArena);
+
+  // an island is awake as soon as one of its bodies is, which wakes the piles hit by an awake body
+  for (std::size_t island{0}; island < m_islands.getIslandCount(); ++island) {
+    std::span<const std::size_t> bodies{m_islands.getIsland(island)};
+    bool                         isAwake{std::any_of(bodies.begin(), bodies.end(), [this](std::size_t i) { return m_bodies.awakes[i] != 0; })};
+    if (!isAwake)
+      continue;
+    for (std::size_t i : bodies) {
+      if (!m_bodies.awakes[i])
+        setAwake(i, true);
+    }
+  }
+}
 
-  float impulseForce = contactVelocity.dot(p.point.normal);
+void PhysicsSystem::updateSleep(float dt) {
+  if (!m_isSleepingEnabled)
+    return;
+
+  for (std::size_t i{0}; i < m_bodies.size(); ++i) {
+    if (!isActive(i))
+      continue;
+    const ml::vec3 &linearVelocity{m_bodies.linearVelocities[i]};
+    const ml::vec3 &angularVelocity{m_bodies.angularVelocities[i]};
+    if (linearVelocity.dot(linearVelocity) > LINEAR_SLEEP_TOLERANCE * LINEAR_SLEEP_TOLERANCE || angularVelocity.dot(angularVelocity) > ANGULAR_SLEEP_TOLERANCE * ANGULAR_SLEEP_TOLERANCE)
+      m_bodies.sleepTimes[i] = 0.0f;
+    else
+      m_bodies.sleepTimes[i] += dt;
+  }
 
-  // now to work out the effect of inertia ....
-  ml::vec3 inertiaA      = static_cast<ml::vec3>(physA.getInertiaTensor() * relativeA.cross(p.point.normal)).cross(relativeA);
-  ml::vec3 inertiaB      = static_cast<ml::vec3>(physB.getInertiaTensor() * relativeA.cross(p.point.normal)).cross(relativeB);
-  float    angularEffect = (inertiaA + inertiaB).dot(p.point.normal);
+  // a whole island falls asleep at once, a body alone would be woken up by its neighbours straight away
+  for (std::size_t island{0}; island < m_islands.getIslandCount(); ++island) {
+    std::span<const std::size_t> bodies{m_islands.getIsland(island)};
+    bool                         canSleep{std::all_of(bodies.begin(), bodies.end(), [this](std::size_t i) { return m_bodies.sleepTimes[i] >= TIME_TO_SLEEP; })};
+    if (!canSleep)
+      continue;
+    for (std::size_t i : bodies)
+      setAwake(i, false);
+  }
+}
 
-  float cRestitution = 0.66f;  // disperse some kinectic energy
+void PhysicsSystem::setAwake(std::size_t index, bool isAwake) {
+  BodyHandle handle{m_bodies.handleOf(index)};
+  m_bodies.awakes[index]     = isAwake;
+  m_bodies.sleepTimes[index] = 0.0f;
+  if (!isAwake) {
+    m_bodies.linearVelocities[index]  = ml::vec3(0.0f, 0.0f, 0.0f);
+    m_bodies.angularVelocities[index] = ml::vec3(0.0f, 0.0f, 0.0f);
+  }
+  // a sleeping body is static for the broadphase, it is only tested against the awake ones
+  bool isStatic{!isAwake || m_bodies.rigids[index] != 0};
+  m_tree.setStatic(handle, isStatic);
+  if (m_broadphaseType == BroadphaseType::SWEEP_AND_PRUNE)
+    m_sweepAndPrune.setStatic(handle, isStatic);
+}
 
-  float j = (-(1.0f + cRestitution) * impulseForce) / (totalMass + angularEffect);
+bool PhysicsSystem::isActive(std::size_t index) const noexcept {
+  return m_bodies.awakes[index] && !m_bodies.rigids[index];
+}
 
-  ml::vec3 fullImpulse = p.point.normal * j;
-  if (!physA.getIsRigid()) {
-    ml::vec3 reverseImpulse = fullImpulse * -1;
-    // m_logger.Debug("Apply linear impulse {{0}, {1}, {2}} to {3}", reverseImpulse.x, reverseImpulse.y, reverseImpulse.z, p.firstCollider);
-    physA.applyLinearImpulse(fullImpulse * -1);
-    if ((*physA.m_shape.get()).m_shapeType != ShapeType::CAPSULE) {
-      // m_logger.Debug("Apply angular impulse {{0}, {1}, {2}} to {3}", reverseImpulse.x, reverseImpulse.y, reverseImpulse.z, p.firstCollider);
-      physA.applyAngularImpulse(relativeA.cross(fullImpulse * -1));
+void PhysicsSystem::collisionResolution(float dt) {
+  for (CollisionInfo &collision : m_collisions) {
+    std::size_t a{m_bodies.indexOf(collision.firstCollider)};
+    std::size_t b{m_bodies.indexOf(collision.secondCollider)};
+    if (!isActive(a) && !isActive(b))
+      continue;
+    if (collision.touchingSteps == 0 && m_callbackCollision) {
+      m_callbackCollision(collision.firstCollider, collision.secondCollider);
     }
+    addContactConstraint(collision);
   }
-  if (!physB.getIsRigid()) {
-    // m_logger.Debug("Apply linear impulse {{0}, {1}, {2}} to {3}", fullImpulse.x, fullImpulse.y, fullImpulse.z, p.secondCollider);
-    physB.applyLinearImpulse(fullImpulse);
-    if ((*physB.m_shape.get()).m_shapeType != ShapeType::CAPSULE) {
-      // m_logger.Debug("Apply angular impulse {{0}, {1}, {2}} to {3}", fullImpulse.x, fullImpulse.y, fullImpulse.z, p.secondCollider);
-      physB.applyAngularImpulse(relativeB.cross(fullImpulse));
+  m_solver.solve(m_bodies, dt, *m_scheduler, m_stepArena);
+}
+
+void PhysicsSystem::addContactConstraint(CollisionInfo &p) {
+  // m_logger.Debug("Resolve collisions between {0} and {1}", p.firstCollider, p.secondCollider);
+  std::size_t a{m_bodies.indexOf(p.firstCollider)};
+  std::size_t b{m_bodies.indexOf(p.secondCollider)};
+
+  const ICollisionShape &shapeA{asCollisionShape(m_bodies.shapes[a])};
+  const ICollisionShape &shapeB{asCollisionShape(m_bodies.shapes[b])};
+  const ml::mat4 &       matrixA{m_bodies.transforms[a].matrix};
+  const ml::mat4 &       matrixB{m_bodies.transforms[b].matrix};
+
+  // the narrowphase gives world space points
+  ml::vec3 centerA{getEntityWorldPosition(shapeA, matrixA)};
+  ml::vec3 centerB{getEntityWorldPosition(shapeB, matrixB)};
+
+  auto typeA{getShapeType(m_bodies.shapes[a])};
+  auto typeB{getShapeType(m_bodies.shapes[b])};
+
+  // capsules and AABB don't receive angular impulses, an AABB can't show a rotation. At least one of the two bodies is dynamic and gives the island
+  std::size_t island{m_bodies.rigids[a] ? m_islands.getIslandOf(b) : m_islands.getIslandOf(a)};
+  bool        angularA{typeA != ShapeType::CAPSULE && typeA != ShapeType::AABB};
+  bool        angularB{typeB != ShapeType::CAPSULE && typeB != ShapeType::AABB};
+  for (ContactPoint &point : p.getPoints())
+    m_solver.add(a, b, point, point.onA - centerA, point.onB - centerB, angularA, angularB, island);
+}
+
+void PhysicsSystem::integrateForces(float dt) {
+  m_scheduler->parallelFor(m_bodies.size(), BODY_GRAIN, [this, dt](std::size_t begin, std::size_t end) {
+    for (std::size_t i{begin}; i < end; ++i) {
+      if (!m_bodies.awakes[i])
+        continue;
+      // accumulated forces
+      m_bodies.linearVelocities[i] += m_bodies.forces[i] * m_bodies.inverseMasses[i] * dt;
+      m_bodies.angularVelocities[i] += m_bodies.inverseInertiaTensors[i] * m_bodies.torques[i] * dt;
     }
-  }
-  // m_logger.Debug("Collision between {0} and {1} resolved", p.firstCollider, p.secondCollider);
-  */
+  });
+}
+
+// The inner sphere of the body is cast along the displacement, the fraction bringing it just inside the first body on its
+// way is returned
+auto PhysicsSystem::timeOfImpact(std::size_t index, const ml::vec3 &displacement) -> float {
+  InnerSphere sphere{innerSphere(m_bodies.shapes[index], m_bodies.transforms[index].matrix)};
+  float       length{displacement.length()};
+  if (length <= sphere.radius)
+    return 1.0f;  // the discrete contacts of the next step catch everything it can hit
+
+  float    tolerance{sphere.radius * CONTINUOUS_TOLERANCE};
+  ml::vec3 end{sphere.center + displacement};
+  Bounds   swept{Bounds{sphere.center, sphere.center}.merge(Bounds{end, end}).expand(sphere.radius)};
+  float    fraction{1.0f};
+  m_tree.query(swept, [&](BodyHandle handle) {
+    std::size_t other{m_bodies.indexOf(handle)};
+    if (other == index)
+      return true;
+    fraction = withConvexShape(m_bodies.shapes[other], m_bodies.transforms[other].matrix, [&](const ConvexShape &shape) {
+      Segment    core{sphere.center, sphere.center};
+      ConvexCast cast{};
+      if (!castConvex(ConvexShape{core, sphere.radius}, displacement, shape, tolerance, fraction, cast) || cast.isOverlapping)
+        return fraction;  // nothing on the way (a body it slides on or leaves isn't), or overlapping from the start: the discrete contact already handles it
+      return std::min(cast.fraction + tolerance / length, fraction);  // a bit inside, for the narrowphase of the next step
+    });
+    return true;
+  });
+  return fraction;
 }
 
 void PhysicsSystem::integrateVelocity(float dt) {
   float dampingFactor = 1.0f - 0.95f;
   float frameDamping  = powf(dampingFactor, dt);
 
-  /* FIX : auto &entities{getItems()};
-  for (auto &&[entity, physics, transform] : entities) {
-    // m_logger.Debug("Resolve velocity for {0}", entity);
-    ml::vec3 position{transform.matrix.getTranslation()};
-    ml::vec3 linearVel{physics.getLinearVelocity()};
-    position += linearVel * dt;
-
-    transform.matrix.setTranslation(position);
-    // Linear Damping
-    linearVel = linearVel * frameDamping;
-    physics.setLinearVelocity(linearVel);
-    // m_logger.Debug("Set linear velocity to {{0}, {1}, {2}}", linearVel.x, linearVel.y, linearVel.z);
-    // first implem angular
-    Quaternion orientation{Quaternion::fromMatrix(transform.matrix.getRotation())};
-    ml::vec3   angVel{physics.getAngularVelocity()};
-
-    ml::vec3 tempVec{angVel * dt * 0.5f};
-    orientation = orientation + (Quaternion(tempVec.x, tempVec.y, tempVec.z, 0.0f) * orientation);
-
-    orientation.normalize();
-    transform.matrix.setRotation(orientation.toMatrix3());
-    // Damp the angular velocity too
-    angVel = angVel * frameDamping;
-    physics.setAngularVelocity(angVel);
-    // m_logger.Debug("Set linear velocity to {{0}, {1}, {2}}", angVel.x, angVel.y, angVel.z);
-    // m_logger.Debug("Velocity resolved for {0}", entity);
-  } */
+  // the continuous bodies are swept on this thread before anything moves, only the fast ones go through timeOfImpact
+  std::pmr::vector<float> fractions{m_bodies.size(), 1.0f, &m_stepArena};  // of the displacement of each body
+  for (std::size_t i{0}; i < m_bodies.size(); ++i) {
+    if (m_bodies.continuous[i] && isActive(i))
+      fractions[i] = timeOfImpact(i, m_bodies.linearVelocities[i] * dt);
+  }
+
+  m_scheduler->parallelFor(m_bodies.size(), BODY_GRAIN, [this, dt, frameDamping, &fractions](std::size_t begin, std::size_t end) {
+    for (std::size_t i{begin}; i < end; ++i) {
+      if (!m_bodies.awakes[i])
+        continue;
+      // m_logger.Debug("Resolve velocity for {0}", m_bodies.handleOf(i));
+      ml::vec3 &linearVel{m_bodies.linearVelocities[i]};
+      ml::vec3 &angVel{m_bodies.angularVelocities[i]};
+
+      m_bodies.positions[i] += linearVel * (dt * fractions[i]);
+      // Linear Damping
+      linearVel = linearVel * frameDamping;
+      // m_logger.Debug("Set linear velocity to {{0}, {1}, {2}}", linearVel.x, linearVel.y, linearVel.z);
+      // dq/dt = 0.5 * (angVel, 0) * q, integrated on the stored quaternion
+      Quaternion &orientation{m_bodies.orientations[i]};
+
+      ml::vec3 tempVec{angVel * dt * 0.5f};
+      orientation = orientation + (Quaternion(tempVec.x, tempVec.y, tempVec.z, 0.0f) * orientation);
+
+      orientation.normalize();
+      // Damp the angular velocity too
+      angVel = angVel * frameDamping;
+      // m_logger.Debug("Set linear velocity to {{0}, {1}, {2}}", angVel.x, angVel.y, angVel.z);
+      m_bodies.updateWorldState(i);
+      // m_logger.Debug("Velocity resolved for {0}", m_bodies.handleOf(i));
+    }
+  });
 }
 
 void PhysicsSystem::update(float dt, std::uint64_t) {
-  // collisionDections();
-  // collisionResolution();
-  // integrateVelocity(dt);
-  for (std::size_t i{0}; i < 5; ++i) {
-    update2(dt / 5.0f, 0);
+  resetArenas();
+  float substep{dt / static_cast<float>(m_substeps)};
+  for (std::size_t i{0}; i < m_substeps; ++i) {
+    update2(substep, 0);
+  }
+  for (std::size_t i{0}; i < m_bodies.size(); ++i) {
+    m_bodies.forces[i]  = ml::vec3(0.0f, 0.0f, 0.0f);
+    m_bodies.torques[i] = ml::vec3(0.0f, 0.0f, 0.0f);
+  }
+}
+
+// Nothing allocated in the arenas survives an update: the arenas are reused from scratch by the next one
+void PhysicsSystem::resetArenas() {
+  m_stepArena.reset();
+  std::size_t workerCount{m_scheduler->getWorkerCount()};
+  m_workerArenas.resize(workerCount);
+  for (std::unique_ptr<Arena> &arena : m_workerArenas) {
+    if (arena == nullptr)
+      arena = std::make_unique<Arena>();
+    arena->reset();
   }
 }
 
 void PhysicsSystem::update2(float dt, std::uint64_t) {
+  integrateForces(dt);
   collisionDections();
-  collisionResolution();
+  buildIslands();
+  collisionResolution(dt);
   integrateVelocity(dt);
+  updateSleep(dt);
 }
 
 bool PhysicsSystem::RayIntersection(const Ray &r, RayCollision &collision) {
   ml::vec3 position  = r.GetPosition();
   ml::vec3 direction = r.GetDirection();
   // m_logger.Debug("Raycast from {{0}, {1}, {2}} to direction {{3}, {4}, {5}}", position.x, position.y, position.z, direction.x, direction.y, direction.z);
-  /* FIX : auto &entities{getItems()};
-  for (auto &&[entity, physics, transform] : entities) {
-
-    switch (physics.m_shape->m_shapeType) {
-      case ShapeType::AABB:
-        if (RayAABBIntersection(r, transform.matrix, reinterpret_cast<AABB &>(*physics.m_shape), collision)) {
-          collision.node = entity;
-        }
-        break;
-      case ShapeType::OBB:
-        if (RayOBBIntersection(r, transform.matrix, reinterpret_cast<OBB &>(*physics.m_shape), collision)) {
-          collision.node = entity;
-        }
-        break;
-      case ShapeType::SPHERE:
-        if (RaySphereIntersection(r, transform.matrix, reinterpret_cast<Sphere &>(*physics.m_shape), collision)) {
-          collision.node = entity;
-        }
-        break;
-      case ShapeType::CAPSULE:
-        if (RayCapsuleIntersection(r, transform.matrix, reinterpret_cast<Capsule &>(*physics.m_shape), collision)) {
-          collision.node = entity;
-        }
-        break;
-    }
-  }
-  if (collision.rayDistance > 0.0f) {
+  if (castRay(r, collision)) {
     // m_logger.Debug("Raycast found object {0} at {{1}, {2}, {3}}", collision.node, collision.collidedAt.x, collision.collidedAt.y, collision.collidedAt.z);
     return true;
   }
-  // m_logger.Debug("Raycast didn't found anything."); */
+  // m_logger.Debug("Raycast didn't found anything.");
   return false;
 }
 
+void PhysicsSystem::RayIntersection(std::span<const Ray> rays, std::span<RayCollision> results, const RaycastOptions &options) {
+  if (rays.size() != results.size())
+    throw std::invalid_argument{"RayIntersection needs a result for every ray"};
+
+  m_rayOrder.resize(rays.size());
+  for (std::size_t i{0}; i < rays.size(); ++i) {
+    std::uint64_t key{options.isSorted ? directionKey(rays[i].GetDirection()) : 0u};
+    m_rayOrder[i] = key << 32 | i;
+  }
+  if (options.isSorted)
+    std::sort(m_rayOrder.begin(), m_rayOrder.end());
+
+  auto cast{[this, rays, results, &options](std::size_t begin, std::size_t end) {
+    if (options.isPacketed) {
+      for (std::size_t i{begin}; i < end; i += RayPacket::SIZE)
+        castPacket(rays, results, std::span<const std::uint64_t>{m_rayOrder}.subspan(i, std::min(RayPacket::SIZE, end - i)));
+      return;
+    }
+    for (std::size_t i{begin}; i < end; ++i) {
+      std::size_t ray{static_cast<std::size_t>(m_rayOrder[i] & 0xFFFFFFFFu)};
+      results[ray] = RayCollision{};
+      (void)castRay(rays[ray], results[ray]);
+    }
+  }};
+  if (!options.isParallel) {
+    cast(0, rays.size());
+    return;
+  }
+  m_scheduler->parallelFor(rays.size(), RAY_GRAIN, cast);
+}
+
+void PhysicsSystem::castPacket(std::span<const Ray> rays, std::span<RayCollision> results, std::span<const std::uint64_t> order) {
+  std::array<std::size_t, RayPacket::SIZE> indices{};  // lane -> ray
+  RayPacket                                packet{};
+  for (std::uint64_t entry : order) {
+    std::size_t ray{static_cast<std::size_t>(entry & 0xFFFFFFFFu)};
+    results[ray]                   = RayCollision{};
+    indices[packet.add(rays[ray])] = ray;
+  }
+
+  m_tree.raycast(packet, [this, rays, results, &indices, &packet](BodyHandle handle, std::uint32_t lanes) {
+    std::size_t     i{m_bodies.indexOf(handle)};
+    const ml::mat4 &matrix{m_bodies.transforms[i].matrix};
+    CollisionShape &shape{m_bodies.shapes[i]};
+    for (std::uint32_t lane{0}; lane < RayPacket::SIZE; ++lane) {
+      if ((lanes & (1u << lane)) == 0)
+        continue;
+      RayCollision &collision{results[indices[lane]]};
+      if ((this->*RAYCAST_TABLE[shape.index()])(rays[indices[lane]], matrix, shape, collision))
+        collision.node = handle;
+      packet.maxDistances[lane] = collision.rayDistance > 0.0f ? collision.rayDistance : FLT_MAX;
+    }
+  });
+}
+
+bool PhysicsSystem::SphereCast(const Sphere &sphere, const Transform &transform, const ml::vec3 &displacement, ShapeCastCollision &collision, BodyHandle ignored) {
+  Segment core{sphereCore(sphere, transform.matrix)};
+  return castShape(ConvexShape{core, sphere.getRadius()}, sphere.getBounds(transform.matrix), displacement, ignored, collision);
+}
+
+bool PhysicsSystem::CapsuleCast(const Capsule &capsule, const Transform &transform, const ml::vec3 &displacement, ShapeCastCollision &collision, BodyHandle ignored) {
+  Segment core{capsuleCore(capsule, transform.matrix)};
+  return castShape(ConvexShape{core, capsule.getRadius()}, capsule.getBounds(transform.matrix), displacement, ignored, collision);
+}
+
+bool PhysicsSystem::BoxCast(const OBB &box, const Transform &transform, const ml::vec3 &displacement, ShapeCastCollision &collision, BodyHandle ignored) {
+  Box core{Box::fromOBB(box, transform.matrix)};
+  return castShape(ConvexShape{core}, box.getBounds(transform.matrix), displacement, ignored, collision);
+}
+
+// the bodies of the tree overlapping the bounds swept by the shape are cast against, the closest hit shortens the next casts
+bool PhysicsSystem::castShape(const ConvexShape &shape, const Bounds &bounds, const ml::vec3 &displacement, BodyHandle ignored, ShapeCastCollision &collision) {
+  collision = ShapeCastCollision{};
+  Bounds swept{bounds.merge(Bounds{bounds.min + displacement, bounds.max + displacement})};
+  m_tree.query(swept, [&](BodyHandle handle) {
+    if (handle == ignored || !m_tree.getBounds(handle).overlaps(swept))
+      return true;
+    std::size_t i{m_bodies.indexOf(handle)};
+    ConvexCast  cast{};
+    bool        isHit{withConvexShape(m_bodies.shapes[i], m_bodies.transforms[i].matrix, [&](const ConvexShape &target) {
+      return castConvex(shape, displacement, target, SHAPE_CAST_TOLERANCE, collision.fraction, cast);
+    })};
+    if (isHit && (collision.node == INVALID_BODY || cast.fraction < collision.fraction)) {
+      collision.node       = handle;
+      collision.fraction   = cast.fraction;
+      collision.collidedAt = cast.point;
+      collision.normal     = cast.normal;
+    }
+    return true;
+  });
+  return collision.node != INVALID_BODY;
+}
+
+auto PhysicsSystem::overlapSphere(const ml::vec3 &center, float radius, std::span<BodyHandle> handles) const -> std::size_t {
+  Segment core{center, center};
+  return overlapShape(ConvexShape{core, radius}, Bounds{center, center}.expand(radius), handles);
+}
+
+auto PhysicsSystem::overlapBox(const OBB &box, const Transform &transform, std::span<BodyHandle> handles) const -> std::size_t {
+  Box core{Box::fromOBB(box, transform.matrix)};
+  return overlapShape(ConvexShape{core}, box.getBounds(transform.matrix), handles);
+}
+
+auto PhysicsSystem::overlapFrustum(const Frustum &frustum, std::span<BodyHandle> handles) const -> std::size_t {
+  std::size_t count{0};
+  if (handles.empty())
+    return count;
+  m_tree.query(frustum, [this, &frustum, handles, &count](BodyHandle handle) {
+    std::size_t i{m_bodies.indexOf(handle)};
+    // a shape is outside when its point the furthest along the normal of a plane is behind it
+    bool isInside{withConvexShape(m_bodies.shapes[i], m_bodies.transforms[i].matrix, [&frustum](const ConvexShape &shape) {
+      return std::all_of(frustum.planes.begin(), frustum.planes.end(), [&shape](const Frustum::Plane &plane) {
+        return plane.normal.dot(shape.getSupport(plane.normal)) + shape.getRadius() + plane.distance >= 0.0f;
+      });
+    })};
+    if (isInside)
+      handles[count++] = handle;
+    return count < handles.size();
+  });
+  return count;
+}
+
+// the bodies of the tree overlapping the bounds of the shape go through GJK
+auto PhysicsSystem::overlapShape(const ConvexShape &shape, const Bounds &bounds, std::span<BodyHandle> handles) const -> std::size_t {
+  std::size_t count{0};
+  if (handles.empty())
+    return count;
+  m_tree.query(bounds, [this, &shape, &bounds, handles, &count](BodyHandle handle) {
+    if (!m_tree.getBounds(handle).overlaps(bounds))
+      return true;
+    std::size_t i{m_bodies.indexOf(handle)};
+    bool        isOverlapping{withConvexShape(m_bodies.shapes[i], m_bodies.transforms[i].matrix, [&shape](const ConvexShape &target) { return overlapConvex(shape, target); })};
+    if (isOverlapping)
+      handles[count++] = handle;
+    return count < handles.size();
+  });
+  return count;
+}
+
+bool PhysicsSystem::castRay(const Ray &r, RayCollision &collision) {
+  m_tree.raycast(r, FLT_MAX, [this, &r, &collision](BodyHandle handle) {
+    std::size_t     i{m_bodies.indexOf(handle)};
+    const ml::mat4 &matrix{m_bodies.transforms[i].matrix};
+
+    CollisionShape &shape{m_bodies.shapes[i]};
+    bool            hit{(this->*RAYCAST_TABLE[shape.index()])(r, matrix, shape, collision)};
+    if (hit) {
+      collision.node = handle;
+    }
+    // nodes further than the closest hit are culled
+    return collision.rayDistance > 0.0f ? collision.rayDistance : FLT_MAX;
+  });
+  return collision.rayDistance > 0.0f;
+}
+
 bool PhysicsSystem::RaySphereIntersection(const Ray &r, const ml::mat4 &worldTransform, const Sphere &volume, RayCollision &collision) {
   ml::vec3 spherePos    = PhysicsSystem::getEntityWorldPosition(volume, worldTransform);
   float    sphereRadius = volume.getRadius();
@@ -645,42 +803,226 @@ void PhysicsSystem::setCallbackCollision(std::function<void(int, int)> callbackC
   m_callbackCollision = callbackCollision;
 }
 
+auto PhysicsSystem::createBody(PhysicsObject &&object, const Transform &transform) -> BodyHandle {
+  BodyHandle  handle{m_bodies.create(std::move(object), transform)};
+  std::size_t index{m_bodies.indexOf(handle)};
+  Bounds      bounds{getWorldBounds(m_bodies.shapes[index], m_bodies.transforms[index].matrix)};
+  m_tree.insert(handle, bounds, m_bodies.rigids[index]);
+  if (m_broadphaseType == BroadphaseType::SWEEP_AND_PRUNE)
+    m_sweepAndPrune.insert(handle, bounds, m_bodies.rigids[index]);
+  return handle;
+}
+
+void PhysicsSystem::destroyBody(BodyHandle handle) {
+  // the bodies resting on this one must fall
+  for (const CollisionInfo &collision : m_collisions) {
+    if (collision.firstCollider == handle)
+      wakeUp(collision.secondCollider);
+    else if (collision.secondCollider == handle)
+      wakeUp(collision.firstCollider);
+  }
+  m_bodies.destroy(handle);
+  m_tree.remove(handle);
+  if (m_broadphaseType == BroadphaseType::SWEEP_AND_PRUNE)
+    m_sweepAndPrune.remove(handle);
+  m_collisions.removeBody(handle);
+  m_features.removeBody(handle);
+}
+
+auto PhysicsSystem::getBodies() const noexcept -> const BodyStorage & {
+  return m_bodies;
+}
+
+auto PhysicsSystem::getTransform(BodyHandle handle) const -> const Transform & {
+  return m_bodies.transforms[m_bodies.indexOf(handle)];
+}
+
+void PhysicsSystem::setTransform(BodyHandle handle, const Transform &transform) {
+  std::size_t index{m_bodies.indexOf(handle)};
+  m_bodies.setTransform(index, transform);
+  setAwake(index, true);
+  Bounds bounds{getWorldBounds(m_bodies.shapes[index], m_bodies.transforms[index].matrix)};
+  m_tree.move(handle, bounds, ml::vec3(0.0f, 0.0f, 0.0f));
+  if (m_broadphaseType == BroadphaseType::SWEEP_AND_PRUNE)
+    m_sweepAndPrune.update(handle, bounds);
+}
+
+void PhysicsSystem::queryRegion(const Bounds &region, const std::function<bool(BodyHandle)> &callback) const {
+  m_tree.query(region, [this, &region, &callback](BodyHandle handle) {
+    if (!m_tree.getBounds(handle).overlaps(region))
+      return true;
+    return callback(handle);
+  });
+}
+
+void PhysicsSystem::setBroadphaseType(BroadphaseType type) {
+  if (type == m_broadphaseType)
+    return;
+  m_broadphaseType = type;
+  m_sweepAndPrune  = SweepAndPrune{};
+  if (type == BroadphaseType::SWEEP_AND_PRUNE) {
+    for (std::size_t i{0}; i < m_bodies.size(); ++i) {
+      BodyHandle handle{m_bodies.handleOf(i)};
+      m_sweepAndPrune.insert(handle, m_tree.getBounds(handle), !isActive(i));
+    }
+  }
+}
+
+auto PhysicsSystem::getBroadphaseType() const noexcept -> BroadphaseType {
+  return m_broadphaseType;
+}
+
+void PhysicsSystem::setSolverIterations(std::size_t iterations) {
+  m_solver.setIterations(iterations);
+}
+
+auto PhysicsSystem::getSolverIterations() const noexcept -> std::size_t {
+  return m_solver.getIterations();
+}
+
+void PhysicsSystem::setWorkerCount(std::size_t workerCount) {
+  bool isInternal{m_scheduler == m_jobSystem.get()};
+  m_jobSystem = std::make_unique<JobSystem>(workerCount == 0 ? std::thread::hardware_concurrency() : workerCount);
+  if (isInternal)
+    m_scheduler = m_jobSystem.get();
+}
+
+auto PhysicsSystem::getWorkerCount() const noexcept -> std::size_t {
+  return m_scheduler->getWorkerCount();
+}
+
+void PhysicsSystem::setJobScheduler(IJobScheduler *scheduler) {
+  m_scheduler = scheduler != nullptr ? scheduler : m_jobSystem.get();
+}
+
+void PhysicsSystem::setSubsteps(std::size_t substeps) {
+  if (substeps == 0)
+    throw std::invalid_argument{"the physics needs at least one substep"};
+  m_substeps = substeps;
+}
+
+auto PhysicsSystem::getSubsteps() const noexcept -> std::size_t {
+  return m_substeps;
+}
+
+auto PhysicsSystem::getShape(BodyHandle handle) -> CollisionShape & {
+  return m_bodies.shapes[m_bodies.indexOf(handle)];
+}
+
+auto PhysicsSystem::getLinearVelocity(BodyHandle handle) const -> ml::vec3 {
+  return m_bodies.linearVelocities[m_bodies.indexOf(handle)];
+}
+
+void PhysicsSystem::setLinearVelocity(BodyHandle handle, const ml::vec3 &velocity) {
+  std::size_t index{m_bodies.indexOf(handle)};
+  setAwake(index, true);
+  m_bodies.linearVelocities[index] = velocity;
+}
+
+auto PhysicsSystem::getAngularVelocity(BodyHandle handle) const -> ml::vec3 {
+  return m_bodies.angularVelocities[m_bodies.indexOf(handle)];
+}
+
+void PhysicsSystem::setAngularVelocity(BodyHandle handle, const ml::vec3 &velocity) {
+  std::size_t index{m_bodies.indexOf(handle)};
+  setAwake(index, true);
+  m_bodies.angularVelocities[index] = velocity;
+}
+
+void PhysicsSystem::applyLinearImpulse(BodyHandle handle, const ml::vec3 &impulse, bool wake) {
+  std::size_t index{m_bodies.indexOf(handle)};
+  if (wake)
+    setAwake(index, true);
+  else if (!m_bodies.awakes[index])
+    return;
+  m_bodies.linearVelocities[index] += impulse * m_bodies.inverseMasses[index];
+}
+
+void PhysicsSystem::applyAngularImpulse(BodyHandle handle, const ml::vec3 &impulse, bool wake) {
+  std::size_t index{m_bodies.indexOf(handle)};
+  if (wake)
+    setAwake(index, true);
+  else if (!m_bodies.awakes[index])
+    return;
+  m_bodies.angularVelocities[index] += m_bodies.inverseInertiaTensors[index] * impulse;
+}
+
+void PhysicsSystem::addForce(BodyHandle handle, const ml::vec3 &force, bool wake) {
+  std::size_t index{m_bodies.indexOf(handle)};
+  if (wake)
+    setAwake(index, true);
+  else if (!m_bodies.awakes[index])
+    return;
+  m_bodies.forces[index] += force;
+}
+
+void PhysicsSystem::addTorque(BodyHandle handle, const ml::vec3 &torque, bool wake) {
+  std::size_t index{m_bodies.indexOf(handle)};
+  if (wake)
+    setAwake(index, true);
+  else if (!m_bodies.awakes[index])
+    return;
+  m_bodies.torques[index] += torque;
+}
+
+bool PhysicsSystem::isAwake(BodyHandle handle) const {
+  return m_bodies.awakes[m_bodies.indexOf(handle)] != 0;
+}
+
+void PhysicsSystem::wakeUp(BodyHandle handle) {
+  setAwake(m_bodies.indexOf(handle), true);
+}
+
+void PhysicsSystem::setSleepingEnabled(bool isSleepingEnabled) {
+  m_isSleepingEnabled = isSleepingEnabled;
+  if (isSleepingEnabled)
+    return;
+  for (std::size_t i{0}; i < m_bodies.size(); ++i) {
+    if (!m_bodies.awakes[i])
+      setAwake(i, true);
+  }
+}
+
+bool PhysicsSystem::isSleepingEnabled() const noexcept {
+  return m_isSleepingEnabled;
+}
+
+void PhysicsSystem::setContinuous(BodyHandle handle, bool isContinuous) {
+  m_bodies.continuous[m_bodies.indexOf(handle)] = isContinuous;
+}
+
+bool PhysicsSystem::isContinuous(BodyHandle handle) const {
+  return m_bodies.continuous[m_bodies.indexOf(handle)] != 0;
+}
 
 bool PhysicsSystem::RayAABBIntersection(const Ray &r, const ml::mat4 &worldTransform, AABB &volume, RayCollision &collision) {
   ml::vec3 boxPos           = PhysicsSystem::getEntityWorldPosition(volume, worldTransform);
-  auto     firstPoints      = volume.getPoints(worldTransform);
-  auto     minFirstCollider = firstPoints.front();
-  auto     maxFirstCollider = firstPoints.back();
-  auto     boxSize          = (maxFirstCollider - minFirstCollider) * 0.5f;
+  Bounds   bounds           = volume.getBounds(worldTransform);
+  auto     boxSize          = (bounds.max - bounds.min) * 0.5f;
   return RayBoxIntersection(r, boxPos, boxSize, collision);
 }
 
 bool PhysicsSystem::RayOBBIntersection(const Ray &r, const ml::mat4 &worldTransform, OBB &volume, RayCollision &collision) {
-  Quaternion orientation  = Quaternion::fromMatrix(worldTransform.getRotation());
-  ml::vec3   position     = PhysicsSystem::getEntityWorldPosition(volume, worldTransform);
-  auto       transform    = orientation.toMatrix3();
-  auto       invTransform = orientation.conjugate().toMatrix3();
-  ml::vec3   localRayPos  = r.GetPosition() - position;
-  Ray        tempRay(invTransform * localRayPos, invTransform * r.GetDirection());
-  auto       firstPoints      = volume.getPoints(worldTransform);
-  auto       minFirstCollider = firstPoints.front();
-  auto       maxFirstCollider = firstPoints.back();
-  auto       boxSize          = (maxFirstCollider - minFirstCollider) * 0.5f;
+  // the transforms can be scaled, the affine inverse keeps the parameter of the ray: its distances stay in world space
+  ml::mat4         worldToLocal{worldTransform.affineInverse()};
+  ml::vec3         worldDirection{r.GetDirection()};
+  Vector<float, 4> direction{worldToLocal * Vector<float, 4>{std::array<float, 4>{worldDirection.x, worldDirection.y, worldDirection.z, 0.0f}}};
+  ml::vec3         localCenter = volume.getLocalPosition();
+  Ray              tempRay(worldToLocal * r.GetPosition() - localCenter, ml::vec3(direction[0], direction[1], direction[2]));
+  auto             boxSize = (volume.getMax() - volume.getMin()) * 0.5f;  // local half size, the ray is already in the box space
 
   bool collided = RayBoxIntersection(tempRay, ml::vec3(0, 0, 0), boxSize, collision);
   if (collided) {
-    collision.collidedAt = transform * collision.collidedAt + position;
+    collision.collidedAt = worldTransform * (collision.collidedAt + localCenter);
   }
   return collided;
 }
 
 bool PhysicsSystem::RayCapsuleIntersection(const Ray &r, const ml::mat4 &worldTransform, Capsule &volume, RayCollision &collision) {
-  std::vector<ml::vec3> pointsFirstCollider{volume.getPoints(worldTransform)};
-  ml::vec3              a_Normal = pointsFirstCollider.front() - pointsFirstCollider.back();
-  a_Normal.normalize();
-  ml::vec3 a_LineEndOffset = a_Normal * volume.getRadius();
-  ml::vec3 a_A             = pointsFirstCollider.back() + a_LineEndOffset;
-  ml::vec3 a_B             = pointsFirstCollider.front() - a_LineEndOffset;
+  // the core doesn't touch the cache of the capsule, rays can be cast concurrently
+  Segment  core{capsuleCore(volume, worldTransform)};
+  ml::vec3 a_A = core.start;
+  ml::vec3 a_B = core.end;
 
   // RAY
   ml::vec3 b_A = r.GetPosition();
@@ -713,7 +1055,7 @@ bool PhysicsSystem::RayCapsuleIntersection(const Ray &r, const ml::mat4 &worldTr
   float    len                = penetration_normal.length();
   penetration_normal.normalize();
   float penetration_depth = volume.getRadius() - len;
-  if ((penetration_depth > 0 && (PhysicsSystem::getEntityWorldPosition(volume, worldTransform) - r.GetPosition()).length() < collision.rayDistance) || collision.rayDistance == 0) {
+  if (penetration_depth > 0 && ((PhysicsSystem::getEntityWorldPosition(volume, worldTransform) - r.GetPosition()).length() < collision.rayDistance || collision.rayDistance == 0)) {
     collision.collidedAt  = PhysicsSystem::getEntityWorldPosition(volume, worldTransform);
     collision.rayDistance = (PhysicsSystem::getEntityWorldPosition(volume, worldTransform) - r.GetPosition()).length();
     return true;
@@ -1,13 +1,36 @@
 #pragma once
 
+#include <functional>
+#include <array>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
 #include "Transform.hpp"
 #include "PhysicsObject.hpp"
+#include "BodyStorage.hpp"
+#include "CollisionShape.hpp"
+#include "CollisionInfo.hpp"
+#include "PairCache.hpp"
+#include "Solver/ContactSolver.hpp"
+#include "Solver/IslandBuilder.hpp"
+#include "Jobs/IJobScheduler.hpp"
+#include "Jobs/JobSystem.hpp"
+#include "Memory/Arena.hpp"
+#include "Broadphase/BroadphaseType.hpp"
+#include "Broadphase/SweepAndPrune.hpp"
+#include "Broadphase/DynamicTree.hpp"
+#include "Narrowphase/Gjk.hpp"
 
 #include "Shapes/AABB.hpp"
 #include "Shapes/Sphere.hpp"
 #include "Shapes/OBB.hpp"
 #include "Shapes/Capsule.hpp"
 #include "Shapes/Raycasting.hpp"
+#include "Shapes/Bounds.hpp"
+#include "Shapes/Frustum.hpp"
 
 #include "Maths/Math.hpp"
 #include "Log.hpp"
@@ -18,48 +41,75 @@ namespace Systems {
   class Physics;
 }
 
-class ContactPoint final {
-public:
-  ml::vec3 localA{0.0f, 0.0f, 0.0f};  // where did the collision occur ...
-  ml::vec3 localB{0.0f, 0.0f, 0.0f};  // in the frame of each object !
-  ml::vec3 normal{0.0f, 0.0f, 0.0f};  // In world space too
-  float    penetration{-FLT_MAX};
+struct RayCollision {
+  BodyHandle              node{INVALID_BODY};                 // Body that was hit
+  ml::vec3                collidedAt{0.0f, 0.0f, 0.0f};  // WORLD SPACE pos of the collision !
+  float                   rayDistance = 0;
 };
 
-class CollisionInfo final {
-public:
-  ContactPoint            point{};
-  int firstCollider{};
-  int secondCollider{};
-  int                     framesLeft{2};
-
+// How PhysicsSystem::RayIntersection casts a batch of rays
+class RaycastOptions final {
 public:
-  DLLATTRIB void addContactPoint(const ml::vec3 &localA, const ml::vec3 &localB, const ml::vec3 &normal, float p);
+  bool isSorted{true};     // cast the rays ordered by direction, the rays going the same way visit the same nodes of the tree
+  bool isParallel{false};  // split the rays in jobs of PhysicsSystem::RAY_GRAIN rays on the scheduler of the PhysicsSystem
+  bool isPacketed{true};   // traverse the tree with packets of RayPacket::SIZE consecutive rays instead of one ray at a time
 };
 
-struct RayCollision {
-  int node;                          // Node that was hit
-  ml::vec3                collidedAt{0.0f, 0.0f, 0.0f};  // WORLD SPACE pos of the collision !
-  float                   rayDistance = 0;
+// First body hit by a shape cast
+class ShapeCastCollision final {
+public:
+  BodyHandle node{INVALID_BODY};
+  float      fraction{1.0f};                // of the displacement done before the hit, the time of impact
+  ml::vec3   collidedAt{0.0f, 0.0f, 0.0f};  // WORLD SPACE, on the surface of the body hit
+  ml::vec3   normal{0.0f, 0.0f, 0.0f};      // of the body hit, facing the cast shape. Null when their cores overlap from the start
 };
 
 // https://research.ncl.ac.uk/game/mastersdegree/gametechnologies/physicstutorials/4collisiondetection/Physics%20-%20Collision%20Detection.pdf
 // https://research.ncl.ac.uk/game/mastersdegree/gametechnologies/physicstutorials/5collisionresponse/Physics%20-%20Collision%20Response.pdf
 class PhysicsSystem {
 private:
-  std::vector<CollisionInfo> m_collisions;
+  BodyStorage                 m_bodies{};
+  BroadphaseType              m_broadphaseType{BroadphaseType::DYNAMIC_TREE};
+  SweepAndPrune               m_sweepAndPrune{};  // only filled when it is the selected broadphase
+  DynamicTree                 m_tree{};           // always up to date, used by the queries
+  std::vector<BroadphasePair> m_pairs{};
+  PairCache                   m_collisions{};
+  PairTable<PairFeatures>     m_features{};  // every pair found by the broadphase at the last step, touching or not
+  ContactSolver               m_solver{};
+  std::size_t                 m_substeps{1};
+  IslandBuilder               m_islands{};
+  bool                        m_isSleepingEnabled{true};
+
+  std::unique_ptr<JobSystem>               m_jobSystem{std::make_unique<JobSystem>(1)};
+  IJobScheduler *                          m_scheduler{m_jobSystem.get()};  // m_jobSystem or the scheduler of the host application
+  std::vector<Bounds>                      m_worldBounds{};                 // dense body index -> bounds, only filled for the active bodies
+  std::vector<std::vector<BroadphasePair>> m_pairChunks{};                  // pairs found by each chunk of the tree, concatenated in order
+  std::vector<std::pmr::vector<CollisionInfo>> m_workerContacts{};  // contacts found by each worker, in the arena of the worker
+  std::vector<std::uint64_t>                   m_rayOrder{};        // direction key << 32 | index of the rays of the last batch
+
+  // transient data of an update, reset at its start
+  Arena                               m_stepArena{};
+  std::vector<std::unique_ptr<Arena>> m_workerArenas{};  // one per worker of m_scheduler, for the allocations made by the jobs
 
   Log m_logger{"PhysicsSystem"};
   std::function<void(int, int)> m_callbackCollision{};
 private:
   DLLATTRIB void                      collisionDections();
-  DLLATTRIB void                      collisionResolution();
-  DLLATTRIB void                      impulseResolveCollision(CollisionInfo &p) const;
+  DLLATTRIB void                      resetArenas();
+  DLLATTRIB void                      updateBroadphase();
+  DLLATTRIB void                      findBroadphasePairs();
+  DLLATTRIB void                      collisionResolution(float dt);
+  DLLATTRIB void                      addContactConstraint(CollisionInfo &p);
+  DLLATTRIB void                      integrateForces(float dt);
   DLLATTRIB void                      integrateVelocity(float dt);
-  [[nodiscard]] DLLATTRIB bool        checkCollisionExists(CollisionInfo existedOne, CollisionInfo toCompare);
+  [[nodiscard]] DLLATTRIB auto        timeOfImpact(std::size_t index, const ml::vec3 &displacement) -> float;
+  DLLATTRIB void                      buildIslands();
+  DLLATTRIB void                      updateSleep(float dt);
+  DLLATTRIB void                      setAwake(std::size_t index, bool isAwake);
+  [[nodiscard]] DLLATTRIB bool        isActive(std::size_t index) const noexcept;  // awake and not rigid
   [[nodiscard]] DLLATTRIB static auto closestPointOnLineSegment(ml::vec3 A, ml::vec3 B, ml::vec3 Point) -> ml::vec3;
-  [[nodiscard]] DLLATTRIB static auto getEntityWorldPositionAABB(const ICollisionShape &shape, const ml::mat4 &matrix) -> ml::vec3;
   [[nodiscard]] DLLATTRIB static auto getEntityWorldPosition(const ICollisionShape &shape, const ml::mat4 &matrix) -> ml::vec3;
+  [[nodiscard]] DLLATTRIB static auto getWorldBounds(const CollisionShape &shape, const ml::mat4 &matrix) -> Bounds;
 
   [[nodiscard]] DLLATTRIB static bool collide(AABB &firstCollider, const ml::mat4 &modelMatrixFirstCollider, AABB &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept;
   [[nodiscard]] DLLATTRIB static bool collide(const Sphere &firstCollider, const ml::mat4 &modelMatrixFirstCollider, const Sphere &secondCollider, const ml::mat4 &modelMatrixSecondcollider, CollisionInfo &collisionInfo) noexcept;
@@ -68,6 +118,9 @@ private:
   [[nodiscard]] DLLATTRIB static bool collide(Capsule &firstCollider, const ml::mat4 &modelMatrixFirstCollider, Capsule &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept;  // https://wickedengine.net/2020/04/26/capsule-collision-detection/
   [[nodiscard]] DLLATTRIB static bool collide(Capsule &firstCollider, const ml::mat4 &modelMatrixFirstCollider, const Sphere &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept;
   [[nodiscard]] DLLATTRIB static bool collide(AABB &firstCollider, const ml::mat4 &modelMatrixFirstCollider, Capsule &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept;
+  [[nodiscard]] DLLATTRIB static bool collide(OBB &firstCollider, const ml::mat4 &modelMatrixFirstCollider, const Sphere &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept;
+  [[nodiscard]] DLLATTRIB static bool collide(OBB &firstCollider, const ml::mat4 &modelMatrixFirstCollider, AABB &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept;
+  [[nodiscard]] DLLATTRIB static bool collide(OBB &firstCollider, const ml::mat4 &modelMatrixFirstCollider, Capsule &secondCollider, const ml::mat4 &modelMatrixSecondCollider, CollisionInfo &collisionInfo) noexcept;
 
   [[nodiscard]] DLLATTRIB bool RaySphereIntersection(const Ray &r, const ml::mat4 &worldTransform, const Sphere &volume, RayCollision &collision);
 
@@ -79,12 +132,123 @@ private:
 
   [[nodiscard]] DLLATTRIB bool RayCapsuleIntersection(const Ray &r, const ml::mat4 &worldTransform, Capsule &volume, RayCollision &collision);
 
+  [[nodiscard]] DLLATTRIB bool collide(std::size_t first, std::size_t second, CollisionInfo &collisionInfo);
+  [[nodiscard]] DLLATTRIB bool castRay(const Ray &r, RayCollision &collision);  // only reads the bodies, the rays of a batch can be cast concurrently
+  [[nodiscard]] DLLATTRIB bool castShape(const ConvexShape &shape, const Bounds &bounds, const ml::vec3 &displacement, BodyHandle ignored, ShapeCastCollision &collision);
+  [[nodiscard]] DLLATTRIB auto overlapShape(const ConvexShape &shape, const Bounds &bounds, std::span<BodyHandle> handles) const -> std::size_t;
+  DLLATTRIB void               castPacket(std::span<const Ray> rays, std::span<RayCollision> results, std::span<const std::uint64_t> order);  // the rays of up to RayPacket::SIZE entries of m_rayOrder
+
+  // Compile time dispatch over every couple of shapes, indexed by CollisionShape::index() (the ShapeType minus UNKNOWN)
+  static constexpr std::size_t SHAPE_COUNT{std::variant_size_v<CollisionShape>};
+  using CollideFunction = bool (*)(CollisionShape &, const ml::mat4 &, CollisionShape &, const ml::mat4 &, CollisionInfo &);
+  using RayFunction     = bool (PhysicsSystem::*)(const Ray &, const ml::mat4 &, CollisionShape &, RayCollision &);
+
+  class NarrowphaseEntry final {
+  public:
+    CollideFunction collide{nullptr};
+  };
+
+  template <class First, class Second>
+  static bool collidePair(CollisionShape &first, const ml::mat4 &firstMatrix, CollisionShape &second, const ml::mat4 &secondMatrix, CollisionInfo &collisionInfo);
+  template <class Shape>
+  bool raycastShape(const Ray &r, const ml::mat4 &worldTransform, CollisionShape &shape, RayCollision &collision);
+  template <std::size_t Row, std::size_t... Columns>
+  static constexpr auto makeNarrowphaseRow(std::index_sequence<Columns...>) -> std::array<NarrowphaseEntry, SHAPE_COUNT>;
+  template <std::size_t... Rows>
+  static constexpr auto makeNarrowphaseTable(std::index_sequence<Rows...>) -> std::array<std::array<NarrowphaseEntry, SHAPE_COUNT>, SHAPE_COUNT>;
+  template <std::size_t... Shapes>
+  static constexpr auto makeRaycastTable(std::index_sequence<Shapes...>) -> std::array<RayFunction, SHAPE_COUNT>;
+
+  static const std::array<std::array<NarrowphaseEntry, SHAPE_COUNT>, SHAPE_COUNT> NARROWPHASE_TABLE;
+  static const std::array<RayFunction, SHAPE_COUNT>                               RAYCAST_TABLE;
+
 public:
+  // a body slower than these tolerances for TIME_TO_SLEEP seconds can fall asleep, with the rest of its island
+  static constexpr float LINEAR_SLEEP_TOLERANCE{0.05f};   // m/s
+  static constexpr float ANGULAR_SLEEP_TOLERANCE{0.05f};  // rad/s
+  static constexpr float TIME_TO_SLEEP{0.5f};             // s
+
+  // a continuous body stops with its inner sphere that deep in the first body on its way, in a fraction of its radius
+  static constexpr float CONTINUOUS_TOLERANCE{0.05f};
+  // a shape cast stops that close to the body it hits
+  static constexpr float SHAPE_CAST_TOLERANCE{1.0e-3f};
+
+  // items handled by a single job of the scheduler
+  static constexpr std::size_t BODY_GRAIN{256};
+  static constexpr std::size_t NODE_GRAIN{512};
+  static constexpr std::size_t PAIR_GRAIN{64};
+  static constexpr std::size_t RAY_GRAIN{256};
+
   DLLATTRIB explicit PhysicsSystem() {};
   [[nodiscard]] DLLATTRIB bool RayIntersection(const Ray &r, RayCollision &collision);
-  [[nodiscard]] DLLATTRIB void setCallbackCollision(std::function<void(int, int)> callbackCollision);
-
-  DLLATTRIB void update2(float dt, std::uint64_t);
+  // results[i] gets the closest hit of rays[i], its node is INVALID_BODY when it hits nothing.
+  // Throw std::invalid_argument when the two spans don't have the same size
+  DLLATTRIB void RayIntersection(std::span<const Ray> rays, std::span<RayCollision> results, const RaycastOptions &options = RaycastOptions{});
+
+  // Move the shape placed by transform along displacement and find the first body it hits, false when it hits nothing.
+  // The ignored body (the character doing the cast) is skipped, a body overlapping the shape from the start is hit at fraction 0
+  // unless the shape only touches it and moves along or away from it, like a character standing on the floor
+  [[nodiscard]] DLLATTRIB bool SphereCast(const Sphere &sphere, const Transform &transform, const ml::vec3 &displacement, ShapeCastCollision &collision, BodyHandle ignored = INVALID_BODY);
+  [[nodiscard]] DLLATTRIB bool CapsuleCast(const Capsule &capsule, const Transform &transform, const ml::vec3 &displacement, ShapeCastCollision &collision, BodyHandle ignored = INVALID_BODY);
+  [[nodiscard]] DLLATTRIB bool BoxCast(const OBB &box, const Transform &transform, const ml::vec3 &displacement, ShapeCastCollision &collision, BodyHandle ignored = INVALID_BODY);
+
+  DLLATTRIB void               setCallbackCollision(std::function<void(int, int)> callbackCollision);
+
+  // callback(BodyHandle) -> bool, return false to stop the query
+  DLLATTRIB void queryRegion(const Bounds &region, const std::function<bool(BodyHandle)> &callback) const;
+
+  // The bodies overlapping the volume are written to handles and their number is returned, the query stops once handles
+  // is full. Nothing is allocated and the bodies are only read: several threads can query at once, outside of update
+  [[nodiscard]] DLLATTRIB auto overlapSphere(const ml::vec3 &center, float radius, std::span<BodyHandle> handles) const -> std::size_t;
+  [[nodiscard]] DLLATTRIB auto overlapBox(const OBB &box, const Transform &transform, std::span<BodyHandle> handles) const -> std::size_t;
+  [[nodiscard]] DLLATTRIB auto overlapFrustum(const Frustum &frustum, std::span<BodyHandle> handles) const -> std::size_t;  // conservative near the edges of the frustum
+
+  DLLATTRIB void               setBroadphaseType(BroadphaseType type);
+  [[nodiscard]] DLLATTRIB auto getBroadphaseType() const noexcept -> BroadphaseType;
+
+  // the transform can be scaled, but not by 0 nor mirrored: throw std::invalid_argument
+  [[nodiscard]] DLLATTRIB auto createBody(PhysicsObject &&object, const Transform &transform = Transform{}) -> BodyHandle;
+  DLLATTRIB void               destroyBody(BodyHandle handle);
+  [[nodiscard]] DLLATTRIB auto getBodies() const noexcept -> const BodyStorage &;
+
+  [[nodiscard]] DLLATTRIB auto getTransform(BodyHandle handle) const -> const Transform &;
+  DLLATTRIB void               setTransform(BodyHandle handle, const Transform &transform);
+  [[nodiscard]] DLLATTRIB auto getShape(BodyHandle handle) -> CollisionShape &;
+
+  [[nodiscard]] DLLATTRIB auto getLinearVelocity(BodyHandle handle) const -> ml::vec3;
+  DLLATTRIB void               setLinearVelocity(BodyHandle handle, const ml::vec3 &velocity);
+  [[nodiscard]] DLLATTRIB auto getAngularVelocity(BodyHandle handle) const -> ml::vec3;
+  DLLATTRIB void               setAngularVelocity(BodyHandle handle, const ml::vec3 &velocity);
+
+  // wake = false leaves a sleeping body untouched, for the forces applied every frame like the gravity
+  DLLATTRIB void applyLinearImpulse(BodyHandle handle, const ml::vec3 &impulse, bool wake = true);
+  DLLATTRIB void applyAngularImpulse(BodyHandle handle, const ml::vec3 &impulse, bool wake = true);
+  DLLATTRIB void addForce(BodyHandle handle, const ml::vec3 &force, bool wake = true);
+  DLLATTRIB void addTorque(BodyHandle handle, const ml::vec3 &torque, bool wake = true);
+
+  [[nodiscard]] DLLATTRIB bool isAwake(BodyHandle handle) const;
+  DLLATTRIB void               wakeUp(BodyHandle handle);  // wake the body, its island follows on the next update
+  DLLATTRIB void               setSleepingEnabled(bool isSleepingEnabled);  // disabling it wakes every body
+  [[nodiscard]] DLLATTRIB bool isSleepingEnabled() const noexcept;
+
+  // A continuous body moving by more than the radius of the sphere inside its shape during a step is swept against the
+  // broadphase: conservative advancement stops it at its first contact, which the next step resolves, instead of letting
+  // it go through a thin body. The other bodies are taken where they are at the start of the step.
+  DLLATTRIB void               setContinuous(BodyHandle handle, bool isContinuous);
+  [[nodiscard]] DLLATTRIB bool isContinuous(BodyHandle handle) const;
+
+  // update runs `substeps` times detection, resolution and integration, each resolution iterates `iterations` times over the contacts
+  DLLATTRIB void               setSolverIterations(std::size_t iterations);  // throw std::invalid_argument on 0
+  [[nodiscard]] DLLATTRIB auto getSolverIterations() const noexcept -> std::size_t;
+  DLLATTRIB void               setSubsteps(std::size_t substeps);  // throw std::invalid_argument on 0
+  [[nodiscard]] DLLATTRIB auto getSubsteps() const noexcept -> std::size_t;
+
+  // The step is split in jobs run by an internal work stealing JobSystem of setWorkerCount() threads (1 by default: the caller only),
+  // or by the scheduler of the host application. The results don't depend on the number of threads.
+  DLLATTRIB void               setWorkerCount(std::size_t workerCount);  // workers including the thread calling update, 0 picks the number of cores
+  [[nodiscard]] DLLATTRIB auto getWorkerCount() const noexcept -> std::size_t;
+  DLLATTRIB void               setJobScheduler(IJobScheduler *scheduler);  // not owned, nullptr goes back to the internal JobSystem
+
+  DLLATTRIB void update2(float dt, std::uint64_t);  // a single substep
   DLLATTRIB void update(float dt, std::uint64_t);
-
 };
@@ -1,17 +1,21 @@
 #pragma once
 
+#include <array>
+
 #include "Library.hpp"
 #include "Maths/Vectors.hpp"
 #include "ICollisionShape.hpp"
 #include "Transform.hpp"
+#include "Shapes/Bounds.hpp"
 
 // Deduire les deux autres points puis la hitbox
 class AABB final : public ICollisionShape {
 public:
   DLLATTRIB explicit AABB(const ml::vec3 &min, const ml::vec3 &max) noexcept;
-  DLLATTRIB explicit AABB(const AABB &second) noexcept;
+  DLLATTRIB AABB(const AABB &second) noexcept;  // not explicit so shapes can be stored by value in a CollisionShape
 
-  [[nodiscard]] DLLATTRIB auto getPoints(const ml::mat4 &transform, bool forceInvalidate = false) -> std::vector<ml::vec3>;  // Called by collide(...)
+  [[nodiscard]] DLLATTRIB auto getPoints(const ml::mat4 &transform, bool forceInvalidate = false) -> std::array<ml::vec3, 8>;  // Called by collide(...)
+  [[nodiscard]] DLLATTRIB auto getBounds(const ml::mat4 &transform) const noexcept -> Bounds;                            // O(1), doesn't touch the cache
 
   DLLATTRIB void               setMin(const ml::vec3 &min) noexcept;
   [[nodiscard]] DLLATTRIB auto getMin() const noexcept -> ml::vec3;
@@ -23,8 +27,9 @@ public:
   DLLATTRIB ml::vec3 getLocalPosition() const override;
 
 private:
-  ml::vec3              m_min{0.0f, 0.0f, 0.0f};
-  ml::vec3              m_max{0.0f, 0.0f, 0.0f};
-  ml::mat4              m_oldTransform{};
-  std::vector<ml::vec3> m_pointsCache{};
+  ml::vec3                m_min{0.0f, 0.0f, 0.0f};
+  ml::vec3                m_max{0.0f, 0.0f, 0.0f};
+  ml::mat4                m_oldTransform{};
+  std::array<ml::vec3, 8> m_pointsCache{};
+  bool                    m_isCacheValid{false};
 };
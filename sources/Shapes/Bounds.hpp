@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "Maths/Math.hpp"
+
+// World space axis aligned box used by the broadphase and the spatial queries
+class Bounds final {
+public:
+  ml::vec3 min{0.0f, 0.0f, 0.0f};
+  ml::vec3 max{0.0f, 0.0f, 0.0f};
+
+public:
+  [[nodiscard]] inline bool overlaps(const Bounds &other) const noexcept {
+    return min.x <= other.max.x && max.x >= other.min.x && min.y <= other.max.y && max.y >= other.min.y && min.z <= other.max.z && max.z >= other.min.z;
+  }
+
+  [[nodiscard]] inline bool contains(const Bounds &other) const noexcept {
+    return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z && max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+  }
+
+  [[nodiscard]] inline Bounds merge(const Bounds &other) const noexcept {
+    return Bounds{
+    ml::vec3{std::min(min.x, other.min.x), std::min(min.y, other.min.y), std::min(min.z, other.min.z)},
+    ml::vec3{std::max(max.x, other.max.x), std::max(max.y, other.max.y), std::max(max.z, other.max.z)},
+    };
+  }
+
+  [[nodiscard]] inline Bounds expand(float margin) const noexcept {
+    return Bounds{
+    ml::vec3{min.x - margin, min.y - margin, min.z - margin},
+    ml::vec3{max.x + margin, max.y + margin, max.z + margin},
+    };
+  }
+
+  [[nodiscard]] inline ml::vec3 getCenter() const noexcept {
+    return (min + max) * 0.5f;
+  }
+
+  // Bounds of this box once transformed, without transforming its 8 corners :
+  // the world extent on an axis is the local extents weighted by the absolute rotation (Arvo, Graphics Gems 1990)
+  [[nodiscard]] inline Bounds transform(const ml::mat4 &matrix) const noexcept {
+    ml::vec3 center{matrix * getCenter()};
+    ml::vec3 extent{(max - min) * 0.5f};
+    ml::vec3 worldExtent{
+    std::abs(matrix[0][0]) * extent.x + std::abs(matrix[1][0]) * extent.y + std::abs(matrix[2][0]) * extent.z,
+    std::abs(matrix[0][1]) * extent.x + std::abs(matrix[1][1]) * extent.y + std::abs(matrix[2][1]) * extent.z,
+    std::abs(matrix[0][2]) * extent.x + std::abs(matrix[1][2]) * extent.y + std::abs(matrix[2][2]) * extent.z,
+    };
+    return Bounds{center - worldExtent, center + worldExtent};
+  }
+};
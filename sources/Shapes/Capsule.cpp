@@ -4,23 +4,29 @@ Capsule::Capsule(const ml::vec3 &start, const ml::vec3 &end, const float &radius
 
 Capsule::Capsule(const Capsule &second) noexcept : ICollisionShape(ShapeType::CAPSULE), m_start{second.m_start}, m_end{second.m_end}, m_radius{second.m_radius} {}
 
-auto Capsule::getPoints(const ml::mat4 &transform, bool forceInvalidate) -> std::vector<ml::vec3> {
-  if (!forceInvalidate && transform == m_oldTransform && m_pointsCache.size() > 0)
+auto Capsule::getPoints(const ml::mat4 &transform, bool forceInvalidate) -> std::array<ml::vec3, 2> {
+  if (!forceInvalidate && m_isCacheValid && transform == m_oldTransform)
     return m_pointsCache;
 
-  std::vector<ml::vec3> points{m_start, m_end};
+  m_pointsCache  = {transform * m_start, transform * m_end};
+  m_oldTransform = transform;
+  m_isCacheValid = true;
+  return m_pointsCache;
+}
 
-  for (auto &point : points) {
-    point = transform * point;
+auto Capsule::getBounds(const ml::mat4 &transform) const noexcept -> Bounds {
+  ml::vec3 start{transform * m_start};
+  ml::vec3 end{transform * m_end};
+  return Bounds{
+  ml::vec3{std::min(start.x, end.x), std::min(start.y, end.y), std::min(start.z, end.z)},
+  ml::vec3{std::max(start.x, end.x), std::max(start.y, end.y), std::max(start.z, end.z)},
   }
-
-  m_pointsCache  = points;
-  m_oldTransform = transform;
-  return points;
+  .expand(m_radius);
 }
 
 void Capsule::setStart(const ml::vec3 &start) noexcept {
-  m_start = start;
+  m_start        = start;
+  m_isCacheValid = false;
 }
 
 [[nodiscard]] auto Capsule::getStart() const noexcept -> ml::vec3 {
@@ -28,7 +34,8 @@ void Capsule::setStart(const ml::vec3 &start) noexcept {
 }
 
 void Capsule::setEnd(const ml::vec3 &end) noexcept {
-  m_end = end;
+  m_end          = end;
+  m_isCacheValid = false;
 }
 
 [[nodiscard]] auto Capsule::getEnd() const noexcept -> ml::vec3 {
@@ -46,7 +53,7 @@ void Capsule::setRadius(const float &radius) noexcept {
 [[nodiscard]] bool Capsule::operator==(const Capsule &second) const noexcept {
   return (second.m_start == m_start && second.m_end == m_end && second.m_radius == m_radius
           && second.m_oldTransform == m_oldTransform
-          && second.m_pointsCache == second.m_pointsCache);
+          && second.m_isCacheValid == m_isCacheValid);
 }
 
 ml::vec3 Capsule::getLocalPosition() const {
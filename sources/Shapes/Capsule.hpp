@@ -1,16 +1,20 @@
 #pragma once
 
+#include <array>
+
 #include "Library.hpp"
 #include "Maths/Vectors.hpp"
 #include "ICollisionShape.hpp"
 #include "Transform.hpp"
+#include "Shapes/Bounds.hpp"
 
 class Capsule final : public ICollisionShape {
 public:
   DLLATTRIB explicit Capsule(const ml::vec3 &top, const ml::vec3 &bottom, const float &radius) noexcept;
-  DLLATTRIB explicit Capsule(const Capsule &second) noexcept;
+  DLLATTRIB Capsule(const Capsule &second) noexcept;  // not explicit so shapes can be stored by value in a CollisionShape
 
-  [[nodiscard]] DLLATTRIB auto getPoints(const ml::mat4 &transform, bool forceInvalidate = false) -> std::vector<ml::vec3>;  // Called by collide(...)
+  [[nodiscard]] DLLATTRIB auto getPoints(const ml::mat4 &transform, bool forceInvalidate = false) -> std::array<ml::vec3, 2>;  // Called by collide(...)
+  [[nodiscard]] DLLATTRIB auto getBounds(const ml::mat4 &transform) const noexcept -> Bounds;
 
   DLLATTRIB void               setStart(const ml::vec3 &start) noexcept;
   [[nodiscard]] DLLATTRIB auto getStart() const noexcept -> ml::vec3;
@@ -24,9 +28,10 @@ public:
   DLLATTRIB ml::vec3 getLocalPosition() const override;
 
 private:
-  ml::vec3              m_start{0.0f, 0.0f, 0.0f};
-  ml::vec3              m_end{0.0f, 0.0f, 0.0f};
-  float                 m_radius{0.0f};
-  ml::mat4              m_oldTransform{};
-  std::vector<ml::vec3> m_pointsCache{};
+  ml::vec3                m_start{0.0f, 0.0f, 0.0f};
+  ml::vec3                m_end{0.0f, 0.0f, 0.0f};
+  float                   m_radius{0.0f};
+  ml::mat4                m_oldTransform{};
+  std::array<ml::vec3, 2> m_pointsCache{};
+  bool                    m_isCacheValid{false};
 };
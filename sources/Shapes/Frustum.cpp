@@ -0,0 +1,23 @@
+#include <cmath>
+
+#include "Frustum.hpp"
+
+auto Frustum::fromMatrix(const ml::mat4 &viewProjection) noexcept -> Frustum {
+  // the matrices are stored [column][row], a clip space coordinate is row(i).dot(p, 1)
+  auto row{[&viewProjection](std::uint32_t i) { return std::array<float, 4>{viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]}; }};
+  auto plane{[](const std::array<float, 4> &a, const std::array<float, 4> &b, float sign) {
+    ml::vec3 normal{a[0] + sign * b[0], a[1] + sign * b[1], a[2] + sign * b[2]};
+    float    length{normal.length()};
+    return Plane{normal * (1.0f / length), (a[3] + sign * b[3]) / length};
+  }};
+
+  std::array<float, 4> w{row(3)};
+  Frustum              frustum{};
+  frustum.planes[PLANE_LEFT]   = plane(w, row(0), 1.0f);
+  frustum.planes[PLANE_RIGHT]  = plane(w, row(0), -1.0f);
+  frustum.planes[PLANE_BOTTOM] = plane(w, row(1), 1.0f);
+  frustum.planes[PLANE_TOP]    = plane(w, row(1), -1.0f);
+  frustum.planes[PLANE_NEAR]   = plane(w, row(2), 1.0f);
+  frustum.planes[PLANE_FAR]    = plane(w, row(2), -1.0f);
+  return frustum;
+}
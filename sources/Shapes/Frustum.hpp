@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "Shapes/Bounds.hpp"
+
+#include "Maths/Math.hpp"
+#include "Library.hpp"
+
+// Convex volume bounded by 6 planes, like the view volume of a camera. A point p is inside a plane when
+// normal.dot(p) + distance >= 0, and inside the frustum when it is inside all its planes
+class Frustum final {
+public:
+  class Plane final {
+  public:
+    ml::vec3 normal{0.0f, 0.0f, 0.0f};  // unit length, towards the inside
+    float    distance{0.0f};
+  };
+
+  enum PlaneIndex {  // NEAR and FAR alone are macros of the Windows headers
+    PLANE_LEFT,
+    PLANE_RIGHT,
+    PLANE_BOTTOM,
+    PLANE_TOP,
+    PLANE_NEAR,
+    PLANE_FAR,
+  };
+
+  std::array<Plane, 6> planes{};
+
+public:
+  // planes of the clip space volume of projection * view, OpenGL conventions (-w <= z <= w).
+  // "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix" by Gil Gribb and Klaus Hartmann
+  [[nodiscard]] DLLATTRIB static auto fromMatrix(const ml::mat4 &viewProjection) noexcept -> Frustum;
+
+  // conservative: false only when the bounds are entirely outside a plane, a box near a corner can be kept
+  [[nodiscard]] inline bool overlaps(const Bounds &bounds) const noexcept {
+    for (const Plane &plane : planes) {
+      // the corner the furthest along the normal
+      ml::vec3 corner{
+      plane.normal.x >= 0.0f ? bounds.max.x : bounds.min.x,
+      plane.normal.y >= 0.0f ? bounds.max.y : bounds.min.y,
+      plane.normal.z >= 0.0f ? bounds.max.z : bounds.min.z,
+      };
+      if (plane.normal.dot(corner) + plane.distance < 0.0f)
+        return false;
+    }
+    return true;
+  }
+};
@@ -0,0 +1,33 @@
+#include <algorithm>
+
+#include "Raycasting.hpp"
+
+auto RayPacket::add(const Ray &ray, float maxDistance) -> std::uint32_t {
+  std::uint32_t lane{count++};
+  ml::vec3      origin{ray.GetPosition()};
+  ml::vec3      direction{ray.GetDirection()};
+  ml::vec3      inverse{0.0f, 0.0f, 0.0f};
+  for (std::uint32_t axis{0}; axis < 3; ++axis) {
+    inverse[axis]                 = direction[axis] != 0.0f ? 1.0f / direction[axis] : FLT_MAX;
+    origins[axis][lane]           = origin[axis];
+    inverseDirections[axis][lane] = inverse[axis];
+  }
+  maxDistances[lane] = maxDistance;
+  activeMask |= 1u << lane;
+
+  if (lane == 0) {
+    m_origin     = origin;
+    m_inverseMin = inverse;
+    m_inverseMax = inverse;
+    return lane;
+  }
+  if (!(origin == m_origin))
+    m_isCoherent = false;
+  for (std::uint32_t axis{0}; axis < 3; ++axis) {
+    if ((inverse[axis] > 0.0f) != (m_inverseMin[axis] > 0.0f))
+      m_isCoherent = false;
+    m_inverseMin[axis] = std::min(m_inverseMin[axis], inverse[axis]);
+    m_inverseMax[axis] = std::max(m_inverseMax[axis], inverse[axis]);
+  }
+  return lane;
+}
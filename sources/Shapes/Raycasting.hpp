@@ -1,7 +1,12 @@
 #pragma once
 
+#include <array>
+#include <cfloat>
+#include <cstdint>
+
 #include "../ICollisionShape.hpp"
 #include "Maths/Vectors.hpp"
+#include "Shapes/Bounds.hpp"
 
 class Ray {
 public:
@@ -19,3 +24,50 @@ protected:
   ml::vec3 position;   // World space position
   ml::vec3 direction;  // Normalised world space direction
 };
+
+// Up to SIZE rays traversing the DynamicTree together, one per SIMD lane: a node is tested against all of them with
+// branchless slab tests on the inverse directions computed once.
+// A packet is coherent when its rays start from the same point and go the same way on every axis, like the sensor sweeps
+// fanning out from one origin: the interval of its inverse directions then culls the nodes missed by all the rays at once
+// (interval arithmetic, "Ray Tracing Animated Scenes using Coherent Grid Traversal" by Wald et al.).
+class RayPacket final {
+public:
+  static constexpr std::size_t SIZE{4};
+
+  using Lanes = std::array<float, SIZE>;
+
+  std::array<Lanes, 3> origins{};            // x, y and z of every lane
+  std::array<Lanes, 3> inverseDirections{};  // FLT_MAX for a null component, the slab tests never make a NaN
+  Lanes                maxDistances{};       // the traversal skips the nodes further than that, shrunk on the hits
+  std::uint32_t        activeMask{0};        // bit i when the lane i holds a ray
+  std::uint32_t        count{0};
+
+public:
+  DLLATTRIB auto add(const Ray &ray, float maxDistance = FLT_MAX) -> std::uint32_t;  // return the lane of the ray, the packet mustn't be full
+
+  // the slab test of the interval of the packet: true when none of its rays can hit bounds, only for a coherent packet
+  [[nodiscard]] inline bool isCulled(const Bounds &bounds) const noexcept {
+    if (!m_isCoherent)
+      return false;
+    float maxDistance{0.0f};
+    for (std::uint32_t lane{0}; lane < count; ++lane)
+      maxDistance = std::max(maxDistance, maxDistances[lane]);
+    float tMin{0.0f};
+    float tMax{maxDistance};
+    for (std::uint32_t axis{0}; axis < 3; ++axis) {
+      // the inverse directions keep their sign on the packet, the near plane is the same for all its rays
+      bool  isPositive{m_inverseMin[axis] > 0.0f};
+      float near{(isPositive ? bounds.min[axis] : bounds.max[axis]) - m_origin[axis]};
+      float far{(isPositive ? bounds.max[axis] : bounds.min[axis]) - m_origin[axis]};
+      tMin = std::max(tMin, std::min(near * m_inverseMin[axis], near * m_inverseMax[axis]));
+      tMax = std::min(tMax, std::max(far * m_inverseMin[axis], far * m_inverseMax[axis]));
+    }
+    return tMin > tMax;
+  }
+
+private:
+  bool     m_isCoherent{true};
+  ml::vec3 m_origin{0.0f, 0.0f, 0.0f};
+  ml::vec3 m_inverseMin{0.0f, 0.0f, 0.0f};  // interval of the inverse directions of the rays on each axis
+  ml::vec3 m_inverseMax{0.0f, 0.0f, 0.0f};
+};
@@ -15,6 +15,11 @@ auto Sphere::getPoints(const ml::mat4 &transform) const noexcept -> ml::vec3 {
   return (transform * m_center);
 }
 
+auto Sphere::getBounds(const ml::mat4 &transform) const noexcept -> Bounds {
+  ml::vec3 center{transform * m_center};
+  return Bounds{center, center}.expand(m_radius);
+}
+
 void Sphere::setRadius(const float &radius) noexcept {
   m_radius = radius;
 }
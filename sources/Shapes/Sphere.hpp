@@ -5,17 +5,19 @@
 #include "Maths/Vectors.hpp"
 #include "ICollisionShape.hpp"
 #include "Transform.hpp"
+#include "Shapes/Bounds.hpp"
 
 class Sphere final : public ICollisionShape {
 public:
   DLLATTRIB explicit Sphere(ml::vec3 center, float radius) noexcept;
-  DLLATTRIB explicit Sphere(const Sphere &second) noexcept;
+  DLLATTRIB Sphere(const Sphere &second) noexcept;  // not explicit so shapes can be stored by value in a CollisionShape
 
   DLLATTRIB void                setCenter(const ml::vec3 &center) noexcept;
   [[nodiscard]] DLLATTRIB auto  getCenter() const noexcept -> ml::vec3;
   DLLATTRIB void                setRadius(const float &radius) noexcept;
   [[nodiscard]] DLLATTRIB float getRadius() const noexcept;
   [[nodiscard]] DLLATTRIB auto  getPoints(const ml::mat4 &transform) const noexcept -> ml::vec3;  // Called by collide(...)
+  [[nodiscard]] DLLATTRIB auto  getBounds(const ml::mat4 &transform) const noexcept -> Bounds;
 
   [[nodiscard]] DLLATTRIB bool operator==(const Sphere &second) const noexcept;
 
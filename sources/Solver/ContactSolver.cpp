@@ -0,0 +1,538 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include "ContactSolver.hpp"
+
+void ContactSolver::setIterations(std::size_t iterations) {
+  if (iterations == 0)
+    throw std::invalid_argument{"the contact solver needs at least one iteration"};
+  m_iterations = iterations;
+}
+
+auto ContactSolver::getIterations() const noexcept -> std::size_t {
+  return m_iterations;
+}
+
+void ContactSolver::add(std::size_t bodyA, std::size_t bodyB, ContactPoint &point, const ml::vec3 &relativeA, const ml::vec3 &relativeB, bool angularA, bool angularB, std::size_t island) {
+  Constraint constraint{};
+  constraint.bodyA     = bodyA;
+  constraint.bodyB     = bodyB;
+  constraint.island    = island;
+  constraint.point     = &point;
+  constraint.relativeA = relativeA;
+  constraint.relativeB = relativeB;
+  constraint.angularA  = angularA;
+  constraint.angularB  = angularB;
+  m_constraints.push_back(constraint);
+}
+
+void ContactSolver::solve(BodyStorage &bodies, float dt, IJobScheduler &scheduler, std::pmr::memory_resource &scratch) {
+  sortByIsland(scratch);
+  colorBigIslands(bodies, scratch);
+  scheduler.parallelFor(m_smallIslands.size(), ISLAND_GRAIN, [this, &bodies, dt](std::size_t begin, std::size_t end) {
+    for (std::size_t i{begin}; i < end; ++i) {
+      std::size_t island{m_smallIslands[i]};
+      solveRange(bodies, dt, std::span<Constraint>{m_constraints}.subspan(m_islandOffsets[island], m_islandOffsets[island + 1] - m_islandOffsets[island]));
+    }
+  });
+  solveColors(bodies, dt, scheduler);
+  clear();
+}
+
+// counting sort, the constraints of an island keep the order they were added in
+void ContactSolver::sortByIsland(std::pmr::memory_resource &scratch) {
+  std::size_t islandCount{0};
+  for (const Constraint &constraint : m_constraints)
+    islandCount = std::max(islandCount, constraint.island + 1);
+
+  m_islandOffsets.assign(islandCount + 1, 0);
+  for (const Constraint &constraint : m_constraints)
+    ++m_islandOffsets[constraint.island + 1];
+  std::partial_sum(m_islandOffsets.begin(), m_islandOffsets.end(), m_islandOffsets.begin());
+
+  std::pmr::vector<std::size_t> cursors(m_islandOffsets.begin(), m_islandOffsets.end() - 1, &scratch);
+  m_sortedConstraints.resize(m_constraints.size());
+  for (const Constraint &constraint : m_constraints)
+    m_sortedConstraints[cursors[constraint.island]++] = constraint;
+  std::swap(m_constraints, m_sortedConstraints);
+}
+
+// Greedy coloring: a constraint takes the first color used by neither of its dynamic bodies.
+// The rigid bodies are never written to, they don't constrain the coloring.
+void ContactSolver::colorBigIslands(const BodyStorage &bodies, std::pmr::memory_resource &scratch) {
+  m_smallIslands.clear();
+  m_coloredConstraints.clear();
+  m_colorOffsets.assign(MAX_COLORS + 2, 0);
+  m_bodyColors.assign(bodies.size(), 0);
+
+  for (std::size_t island{0}; island + 1 < m_islandOffsets.size(); ++island) {
+    std::size_t begin{m_islandOffsets[island]};
+    std::size_t end{m_islandOffsets[island + 1]};
+    if (end - begin < COLORING_THRESHOLD) {
+      m_smallIslands.push_back(island);
+      continue;
+    }
+    for (std::size_t i{begin}; i < end; ++i) {
+      Constraint &  constraint{m_constraints[i]};
+      bool          rigidA{bodies.rigids[constraint.bodyA] != 0};
+      bool          rigidB{bodies.rigids[constraint.bodyB] != 0};
+      std::uint64_t used{(rigidA ? 0 : m_bodyColors[constraint.bodyA]) | (rigidB ? 0 : m_bodyColors[constraint.bodyB])};
+      constraint.color = used == UINT64_MAX ? MAX_COLORS : static_cast<std::size_t>(std::countr_one(used));
+      if (constraint.color < MAX_COLORS) {
+        if (!rigidA)
+          m_bodyColors[constraint.bodyA] |= std::uint64_t{1} << constraint.color;
+        if (!rigidB)
+          m_bodyColors[constraint.bodyB] |= std::uint64_t{1} << constraint.color;
+      }
+      ++m_colorOffsets[constraint.color + 1];
+      m_coloredConstraints.push_back(constraint);
+    }
+  }
+  std::partial_sum(m_colorOffsets.begin(), m_colorOffsets.end(), m_colorOffsets.begin());
+
+  // counting sort by color, from the island order kept in m_coloredConstraints
+  std::pmr::vector<std::size_t> cursors(m_colorOffsets.begin(), m_colorOffsets.end() - 1, &scratch);
+  m_sortedConstraints.resize(m_coloredConstraints.size());
+  for (const Constraint &constraint : m_coloredConstraints)
+    m_sortedConstraints[cursors[constraint.color]++] = constraint;
+  std::swap(m_coloredConstraints, m_sortedConstraints);
+}
+
+// every step goes over the colors one after the other, the constraints of a color are solved in parallel
+void ContactSolver::solveColors(BodyStorage &bodies, float dt, IJobScheduler &scheduler) {
+  if (m_coloredConstraints.empty())
+    return;
+  std::span<Constraint> constraints{m_coloredConstraints};
+  scheduler.parallelFor(constraints.size(), COLOR_GRAIN, [&bodies, dt, constraints](std::size_t begin, std::size_t end) {
+    prepare(bodies, dt, constraints.subspan(begin, end - begin));
+  });
+
+#if ML_SIMD_SSE
+  // the constraints of the overflow share bodies, they can't be packed in lanes and are solved serially
+  std::span<Constraint> overflow{constraints.subspan(m_colorOffsets[MAX_COLORS])};
+  computeMasses(overflow);
+  packColors(scheduler);
+
+  auto forEachColor = [this, &scheduler, overflow](const auto &wideStep, const auto &step) {
+    for (std::size_t color{0}; color < MAX_COLORS; ++color) {
+      std::span<WideConstraint> batches{std::span<WideConstraint>{m_wideConstraints}.subspan(m_wideColorOffsets[color], m_wideColorOffsets[color + 1] - m_wideColorOffsets[color])};
+      scheduler.parallelFor(batches.size(), COLOR_GRAIN / SIMD_LANES, [&wideStep, batches](std::size_t begin, std::size_t end) {
+        wideStep(batches.subspan(begin, end - begin));
+      });
+    }
+    step(overflow);
+  };
+  forEachColor([&bodies](std::span<WideConstraint> range) { warmStart(bodies, range); }, [&bodies](std::span<Constraint> range) { warmStart(bodies, range); });
+  for (std::size_t i{0}; i < m_iterations; ++i)
+    forEachColor([&bodies](std::span<WideConstraint> range) { solveVelocities(bodies, range); }, [&bodies](std::span<Constraint> range) { solveVelocities(bodies, range); });
+  storeImpulses(m_wideConstraints);
+  storeImpulses(overflow);
+#else
+  scheduler.parallelFor(constraints.size(), COLOR_GRAIN, [constraints](std::size_t begin, std::size_t end) {
+    computeMasses(constraints.subspan(begin, end - begin));
+  });
+
+  auto forEachColor = [this, &scheduler, constraints](const auto &step) {
+    for (std::size_t color{0}; color + 1 < m_colorOffsets.size(); ++color) {
+      std::span<Constraint> colored{constraints.subspan(m_colorOffsets[color], m_colorOffsets[color + 1] - m_colorOffsets[color])};
+      // the overflow shares bodies between its constraints, a single job solves it
+      std::size_t grain{color == MAX_COLORS ? std::max<std::size_t>(colored.size(), 1) : COLOR_GRAIN};
+      scheduler.parallelFor(colored.size(), grain, [&step, colored](std::size_t begin, std::size_t end) {
+        step(colored.subspan(begin, end - begin));
+      });
+    }
+  };
+  forEachColor([&bodies](std::span<Constraint> range) { warmStart(bodies, range); });
+  for (std::size_t i{0}; i < m_iterations; ++i)
+    forEachColor([&bodies](std::span<Constraint> range) { solveVelocities(bodies, range); });
+  storeImpulses(constraints);
+#endif
+}
+
+void ContactSolver::solveRange(BodyStorage &bodies, float dt, std::span<Constraint> constraints) {
+  prepare(bodies, dt, constraints);
+  computeMasses(constraints);
+  warmStart(bodies, constraints);
+  for (std::size_t i{0}; i < m_iterations; ++i)
+    solveVelocities(bodies, constraints);
+  storeImpulses(constraints);
+}
+
+void ContactSolver::clear() noexcept {
+  m_constraints.clear();
+}
+
+void ContactSolver::warmStartFrom(const ContactPoint &previous, ContactPoint &current) noexcept {
+  if (previous.normal.dot(current.normal) < WARM_START_MIN_COSINE)
+    return;
+  current.normalImpulse   = previous.normalImpulse;
+  current.tangentImpulse1 = previous.tangentImpulse1;
+  current.tangentImpulse2 = previous.tangentImpulse2;
+}
+
+void ContactSolver::warmStartFrom(const CollisionInfo &previous, CollisionInfo &current) noexcept {
+  std::span<const ContactPoint> previousPoints{previous.getPoints()};
+  for (ContactPoint &point : current.getPoints()) {
+    auto match{std::find_if(previousPoints.begin(), previousPoints.end(), [&point](const ContactPoint &old) { return old.featureId == point.featureId; })};
+    if (match != previousPoints.end())
+      warmStartFrom(*match, point);
+  }
+}
+
+auto ContactSolver::effectiveMass(const Constraint &constraint, const ml::vec3 &direction) -> float {
+  ml::vec3 angularA = static_cast<ml::vec3>(constraint.inverseInertiaA * constraint.relativeA.cross(direction)).cross(constraint.relativeA);
+  ml::vec3 angularB = static_cast<ml::vec3>(constraint.inverseInertiaB * constraint.relativeB.cross(direction)).cross(constraint.relativeB);
+  float    mass     = constraint.inverseMassA + constraint.inverseMassB + (angularA + angularB).dot(direction);
+  return mass > 0.0f ? 1.0f / mass : 0.0f;
+}
+
+auto ContactSolver::relativeVelocity(const BodyStorage &bodies, const Constraint &constraint) -> ml::vec3 {
+  ml::vec3 velocityA = bodies.linearVelocities[constraint.bodyA] + bodies.angularVelocities[constraint.bodyA].cross(constraint.relativeA);
+  ml::vec3 velocityB = bodies.linearVelocities[constraint.bodyB] + bodies.angularVelocities[constraint.bodyB].cross(constraint.relativeB);
+  return velocityB - velocityA;
+}
+
+// impulse is applied on B, its opposite on A. A rigid body can be shared by islands solved at the same time, it is left untouched
+void ContactSolver::applyImpulse(BodyStorage &bodies, const Constraint &constraint, const ml::vec3 &impulse) {
+  if (!constraint.rigidA) {
+    bodies.linearVelocities[constraint.bodyA] -= impulse * constraint.inverseMassA;
+    bodies.angularVelocities[constraint.bodyA] -= constraint.inverseInertiaA * constraint.relativeA.cross(impulse);
+  }
+  if (!constraint.rigidB) {
+    bodies.linearVelocities[constraint.bodyB] += impulse * constraint.inverseMassB;
+    bodies.angularVelocities[constraint.bodyB] += constraint.inverseInertiaB * constraint.relativeB.cross(impulse);
+  }
+}
+
+void ContactSolver::prepare(const BodyStorage &bodies, float dt, std::span<Constraint> constraints) {
+  for (Constraint &constraint : constraints) {
+    const ContactPoint &point{*constraint.point};
+    std::size_t         a{constraint.bodyA};
+    std::size_t         b{constraint.bodyB};
+    bool                rigidA{bodies.rigids[a] != 0};
+    bool                rigidB{bodies.rigids[b] != 0};
+
+    constraint.rigidA          = rigidA;
+    constraint.rigidB          = rigidB;
+    constraint.inverseMassA    = rigidA ? 0.0f : bodies.inverseMasses[a];
+    constraint.inverseMassB    = rigidB ? 0.0f : bodies.inverseMasses[b];
+    constraint.inverseInertiaA = !rigidA && constraint.angularA ? bodies.inverseInertiaTensors[a] : Matrix<float, 3, 3>{};
+    constraint.inverseInertiaB = !rigidB && constraint.angularB ? bodies.inverseInertiaTensors[b] : Matrix<float, 3, 3>{};
+
+    // any orthonormal basis works as long as it only depends on the normal, the cached friction impulses stay meaningful
+    constraint.normal = point.normal;
+    if (std::abs(point.normal.x) >= 0.57735f)
+      constraint.tangent1 = ml::vec3(point.normal.y, -point.normal.x, 0.0f);
+    else
+      constraint.tangent1 = ml::vec3(0.0f, point.normal.z, -point.normal.y);
+    constraint.tangent1.normalize();
+    constraint.tangent2 = point.normal.cross(constraint.tangent1);
+
+    constraint.friction = std::sqrt(bodies.frictions[a] * bodies.frictions[b]);
+
+    // push the bodies apart proportionally to the penetration, and bounce when they hit fast enough
+    constraint.velocityBias = BAUMGARTE / dt * std::max(point.penetration - PENETRATION_SLOP, 0.0f);
+    float approachSpeed     = relativeVelocity(bodies, constraint).dot(constraint.normal);
+    if (approachSpeed < -RESTITUTION_THRESHOLD)
+      constraint.velocityBias = std::max(constraint.velocityBias, -approachSpeed * bodies.elasticities[a] * bodies.elasticities[b]);
+
+    constraint.normalImpulse   = point.normalImpulse;
+    constraint.tangentImpulse1 = point.tangentImpulse1;
+    constraint.tangentImpulse2 = point.tangentImpulse2;
+  }
+}
+
+void ContactSolver::computeMasses(std::span<Constraint> constraints) {
+  for (Constraint &constraint : constraints) {
+    constraint.normalMass   = effectiveMass(constraint, constraint.normal);
+    constraint.tangentMass1 = effectiveMass(constraint, constraint.tangent1);
+    constraint.tangentMass2 = effectiveMass(constraint, constraint.tangent2);
+  }
+}
+
+void ContactSolver::warmStart(BodyStorage &bodies, std::span<const Constraint> constraints) {
+  for (const Constraint &constraint : constraints) {
+    applyImpulse(bodies, constraint, constraint.normal * constraint.normalImpulse + constraint.tangent1 * constraint.tangentImpulse1 + constraint.tangent2 * constraint.tangentImpulse2);
+  }
+}
+
+void ContactSolver::solveVelocities(BodyStorage &bodies, std::span<Constraint> constraints) {
+  for (Constraint &constraint : constraints) {
+    // friction first, bounded by the normal impulse of the previous iteration
+    float    maxFriction = constraint.friction * constraint.normalImpulse;
+    ml::vec3 velocity    = relativeVelocity(bodies, constraint);
+
+    float lambda               = -constraint.tangentMass1 * velocity.dot(constraint.tangent1);
+    float accumulated          = std::clamp(constraint.tangentImpulse1 + lambda, -maxFriction, maxFriction);
+    lambda                     = accumulated - constraint.tangentImpulse1;
+    constraint.tangentImpulse1 = accumulated;
+    applyImpulse(bodies, constraint, constraint.tangent1 * lambda);
+
+    velocity                   = relativeVelocity(bodies, constraint);
+    lambda                     = -constraint.tangentMass2 * velocity.dot(constraint.tangent2);
+    accumulated                = std::clamp(constraint.tangentImpulse2 + lambda, -maxFriction, maxFriction);
+    lambda                     = accumulated - constraint.tangentImpulse2;
+    constraint.tangentImpulse2 = accumulated;
+    applyImpulse(bodies, constraint, constraint.tangent2 * lambda);
+
+    // the bodies can only be pushed apart: the accumulated normal impulse stays positive
+    velocity                 = relativeVelocity(bodies, constraint);
+    lambda                   = constraint.normalMass * (constraint.velocityBias - velocity.dot(constraint.normal));
+    accumulated              = std::max(constraint.normalImpulse + lambda, 0.0f);
+    lambda                   = accumulated - constraint.normalImpulse;
+    constraint.normalImpulse = accumulated;
+    applyImpulse(bodies, constraint, constraint.normal * lambda);
+  }
+}
+
+void ContactSolver::storeImpulses(std::span<const Constraint> constraints) {
+  for (const Constraint &constraint : constraints) {
+    ContactPoint &point{*constraint.point};
+    point.normalImpulse   = constraint.normalImpulse;
+    point.tangentImpulse1 = constraint.tangentImpulse1;
+    point.tangentImpulse2 = constraint.tangentImpulse2;
+  }
+}
+
+#if ML_SIMD_SSE
+
+namespace {
+  using ml::simd::float4;
+  using Lanes = std::array<float, ContactSolver::SIMD_LANES>;
+
+  // x, y and z of one vector per lane
+  class Float3x4 final {
+  public:
+    float4 x;
+    float4 y;
+    float4 z;
+  };
+
+  [[nodiscard]] inline float4 load(const Lanes &lanes) noexcept {
+    return ml::simd::load4(lanes.data());
+  }
+
+  [[nodiscard]] inline Float3x4 load(const std::array<Lanes, 3> &lanes) noexcept {
+    return {load(lanes[0]), load(lanes[1]), load(lanes[2])};
+  }
+
+  inline void store(Lanes &lanes, float4 value) noexcept {
+    ml::simd::store4(lanes.data(), value);
+  }
+
+  [[nodiscard]] inline Float3x4 operator+(const Float3x4 &a, const Float3x4 &b) noexcept {
+    return {ml::simd::add(a.x, b.x), ml::simd::add(a.y, b.y), ml::simd::add(a.z, b.z)};
+  }
+
+  [[nodiscard]] inline Float3x4 operator-(const Float3x4 &a, const Float3x4 &b) noexcept {
+    return {ml::simd::sub(a.x, b.x), ml::simd::sub(a.y, b.y), ml::simd::sub(a.z, b.z)};
+  }
+
+  [[nodiscard]] inline Float3x4 operator*(const Float3x4 &a, float4 factor) noexcept {
+    return {ml::simd::mul(a.x, factor), ml::simd::mul(a.y, factor), ml::simd::mul(a.z, factor)};
+  }
+
+  [[nodiscard]] inline float4 dot(const Float3x4 &a, const Float3x4 &b) noexcept {
+    return ml::simd::madd(a.z, b.z, ml::simd::madd(a.y, b.y, ml::simd::mul(a.x, b.x)));
+  }
+
+  [[nodiscard]] inline Float3x4 cross(const Float3x4 &a, const Float3x4 &b) noexcept {
+    return {ml::simd::sub(ml::simd::mul(a.y, b.z), ml::simd::mul(a.z, b.y)),
+    ml::simd::sub(ml::simd::mul(a.z, b.x), ml::simd::mul(a.x, b.z)),
+    ml::simd::sub(ml::simd::mul(a.x, b.y), ml::simd::mul(a.y, b.x))};
+  }
+
+  // one column major 3x3 matrix per lane
+  [[nodiscard]] inline Float3x4 transform(const std::array<Lanes, 9> &matrix, const Float3x4 &v) noexcept {
+    auto row = [&matrix, &v](std::size_t i) {
+      return ml::simd::madd(load(matrix[6 + i]), v.z, ml::simd::madd(load(matrix[3 + i]), v.y, ml::simd::mul(load(matrix[i]), v.x)));
+    };
+    return {row(0), row(1), row(2)};
+  }
+
+  [[nodiscard]] inline Float3x4 gather(const std::vector<ml::vec3> &values, const std::array<std::size_t, ContactSolver::SIMD_LANES> &indices) noexcept {
+    const ml::vec3 &v0{values[indices[0]]};
+    const ml::vec3 &v1{values[indices[1]]};
+    const ml::vec3 &v2{values[indices[2]]};
+    const ml::vec3 &v3{values[indices[3]]};
+    return {ml::simd::set4(v0.x, v1.x, v2.x, v3.x), ml::simd::set4(v0.y, v1.y, v2.y, v3.y), ml::simd::set4(v0.z, v1.z, v2.z, v3.z)};
+  }
+
+  inline void scatter(std::vector<ml::vec3> &values, const std::array<std::size_t, ContactSolver::SIMD_LANES> &indices, const std::array<bool, ContactSolver::SIMD_LANES> &writes, const Float3x4 &v) noexcept {
+    Lanes x{};
+    Lanes y{};
+    Lanes z{};
+    store(x, v.x);
+    store(y, v.y);
+    store(z, v.z);
+    for (std::size_t lane{0}; lane < ContactSolver::SIMD_LANES; ++lane) {
+      if (writes[lane])
+        values[indices[lane]] = ml::vec3(x[lane], y[lane], z[lane]);
+    }
+  }
+
+  // velocities of the bodies of every lane, read at the start of a batch and written back at its end
+  class WideBodies final {
+  public:
+    Float3x4 linearA;
+    Float3x4 angularA;
+    Float3x4 linearB;
+    Float3x4 angularB;
+  };
+}
+
+void ContactSolver::packColors(IJobScheduler &scheduler) {
+  m_wideColorOffsets.assign(MAX_COLORS + 1, 0);
+  for (std::size_t color{0}; color < MAX_COLORS; ++color) {
+    std::size_t count{m_colorOffsets[color + 1] - m_colorOffsets[color]};
+    m_wideColorOffsets[color + 1] = m_wideColorOffsets[color] + (count + SIMD_LANES - 1) / SIMD_LANES;
+  }
+
+  m_wideConstraints.resize(m_wideColorOffsets.back());
+  scheduler.parallelFor(m_wideConstraints.size(), COLOR_GRAIN / SIMD_LANES, [this](std::size_t begin, std::size_t end) {
+    for (std::size_t i{begin}; i < end; ++i) {
+      // the last color starting at or before i, the empty colors start where the next one does
+      auto        next{std::upper_bound(m_wideColorOffsets.begin(), m_wideColorOffsets.end(), i)};
+      std::size_t color{static_cast<std::size_t>(next - m_wideColorOffsets.begin()) - 1};
+      std::size_t first{m_colorOffsets[color] + (i - m_wideColorOffsets[color]) * SIMD_LANES};
+      std::size_t count{std::min(SIMD_LANES, m_colorOffsets[color + 1] - first)};
+      pack(m_wideConstraints[i], std::span<const Constraint>{m_coloredConstraints}.subspan(first, count));
+      computeMasses(m_wideConstraints[i]);
+    }
+  });
+}
+
+void ContactSolver::pack(WideConstraint &wide, std::span<const Constraint> constraints) {
+  wide = WideConstraint{};
+  for (std::size_t lane{0}; lane < constraints.size(); ++lane) {
+    const Constraint &constraint{constraints[lane]};
+    wide.bodyA[lane]     = constraint.bodyA;
+    wide.bodyB[lane]     = constraint.bodyB;
+    wide.writeA[lane]    = !constraint.rigidA;
+    wide.writeB[lane]    = !constraint.rigidB;
+    wide.point[lane]     = constraint.point;
+    for (std::uint32_t axis{0}; axis < 3; ++axis) {
+      wide.relativeA[axis][lane] = constraint.relativeA[axis];
+      wide.relativeB[axis][lane] = constraint.relativeB[axis];
+      wide.normal[axis][lane]    = constraint.normal[axis];
+      wide.tangent1[axis][lane]  = constraint.tangent1[axis];
+      wide.tangent2[axis][lane]  = constraint.tangent2[axis];
+      for (std::uint32_t row{0}; row < 3; ++row) {
+        wide.inverseInertiaA[axis * 3 + row][lane] = constraint.inverseInertiaA[axis][row];
+        wide.inverseInertiaB[axis * 3 + row][lane] = constraint.inverseInertiaB[axis][row];
+      }
+    }
+    wide.inverseMassA[lane]    = constraint.inverseMassA;
+    wide.inverseMassB[lane]    = constraint.inverseMassB;
+    wide.velocityBias[lane]    = constraint.velocityBias;
+    wide.friction[lane]        = constraint.friction;
+    wide.normalImpulse[lane]   = constraint.normalImpulse;
+    wide.tangentImpulse1[lane] = constraint.tangentImpulse1;
+    wide.tangentImpulse2[lane] = constraint.tangentImpulse2;
+  }
+}
+
+void ContactSolver::computeMasses(WideConstraint &wide) {
+  Float3x4 relativeA{load(wide.relativeA)};
+  Float3x4 relativeB{load(wide.relativeB)};
+  float4   inverseMasses{ml::simd::add(load(wide.inverseMassA), load(wide.inverseMassB))};
+
+  auto effectiveMass = [&](const Float3x4 &direction) {
+    Float3x4 angularA{cross(transform(wide.inverseInertiaA, cross(relativeA, direction)), relativeA)};
+    Float3x4 angularB{cross(transform(wide.inverseInertiaB, cross(relativeB, direction)), relativeB)};
+    return ml::simd::inverseOrZero(ml::simd::add(inverseMasses, dot(angularA + angularB, direction)));
+  };
+  store(wide.normalMass, effectiveMass(load(wide.normal)));
+  store(wide.tangentMass1, effectiveMass(load(wide.tangent1)));
+  store(wide.tangentMass2, effectiveMass(load(wide.tangent2)));
+}
+
+void ContactSolver::warmStart(BodyStorage &bodies, std::span<const WideConstraint> constraints) {
+  for (const WideConstraint &wide : constraints) {
+    Float3x4 relativeA{load(wide.relativeA)};
+    Float3x4 relativeB{load(wide.relativeB)};
+    Float3x4 impulse{load(wide.normal) * load(wide.normalImpulse) + load(wide.tangent1) * load(wide.tangentImpulse1) + load(wide.tangent2) * load(wide.tangentImpulse2)};
+
+    Float3x4 linearA{gather(bodies.linearVelocities, wide.bodyA) - impulse * load(wide.inverseMassA)};
+    Float3x4 angularA{gather(bodies.angularVelocities, wide.bodyA) - transform(wide.inverseInertiaA, cross(relativeA, impulse))};
+    Float3x4 linearB{gather(bodies.linearVelocities, wide.bodyB) + impulse * load(wide.inverseMassB)};
+    Float3x4 angularB{gather(bodies.angularVelocities, wide.bodyB) + transform(wide.inverseInertiaB, cross(relativeB, impulse))};
+    scatter(bodies.linearVelocities, wide.bodyA, wide.writeA, linearA);
+    scatter(bodies.angularVelocities, wide.bodyA, wide.writeA, angularA);
+    scatter(bodies.linearVelocities, wide.bodyB, wide.writeB, linearB);
+    scatter(bodies.angularVelocities, wide.bodyB, wide.writeB, angularB);
+  }
+}
+
+// same steps as the scalar solveVelocities, on the 4 lanes at once
+void ContactSolver::solveVelocities(BodyStorage &bodies, std::span<WideConstraint> constraints) {
+  for (WideConstraint &wide : constraints) {
+    WideBodies body{
+    .linearA  = gather(bodies.linearVelocities, wide.bodyA),
+    .angularA = gather(bodies.angularVelocities, wide.bodyA),
+    .linearB  = gather(bodies.linearVelocities, wide.bodyB),
+    .angularB = gather(bodies.angularVelocities, wide.bodyB),
+    };
+    Float3x4 relativeA{load(wide.relativeA)};
+    Float3x4 relativeB{load(wide.relativeB)};
+    float4   inverseMassA{load(wide.inverseMassA)};
+    float4   inverseMassB{load(wide.inverseMassB)};
+
+    auto relativeVelocity = [&] {
+      return (body.linearB + cross(body.angularB, relativeB)) - (body.linearA + cross(body.angularA, relativeA));
+    };
+    auto applyImpulse = [&](const Float3x4 &impulse) {
+      body.linearA  = body.linearA - impulse * inverseMassA;
+      body.angularA = body.angularA - transform(wide.inverseInertiaA, cross(relativeA, impulse));
+      body.linearB  = body.linearB + impulse * inverseMassB;
+      body.angularB = body.angularB + transform(wide.inverseInertiaB, cross(relativeB, impulse));
+    };
+
+    // friction first, bounded by the normal impulse of the previous iteration
+    float4 normalImpulse{load(wide.normalImpulse)};
+    float4 maxFriction{ml::simd::mul(load(wide.friction), normalImpulse)};
+    float4 minFriction{ml::simd::sub(ml::simd::zero(), maxFriction)};
+    auto   solveFriction = [&](const Float3x4 &tangent, float4 mass, float4 &tangentImpulse) {
+      float4 lambda{ml::simd::mul(ml::simd::sub(ml::simd::zero(), mass), dot(relativeVelocity(), tangent))};
+      float4 accumulated{ml::simd::min(ml::simd::max(ml::simd::add(tangentImpulse, lambda), minFriction), maxFriction)};
+      lambda         = ml::simd::sub(accumulated, tangentImpulse);
+      tangentImpulse = accumulated;
+      applyImpulse(tangent * lambda);
+    };
+    float4 tangentImpulse1{load(wide.tangentImpulse1)};
+    float4 tangentImpulse2{load(wide.tangentImpulse2)};
+    solveFriction(load(wide.tangent1), load(wide.tangentMass1), tangentImpulse1);
+    solveFriction(load(wide.tangent2), load(wide.tangentMass2), tangentImpulse2);
+
+    // the bodies can only be pushed apart: the accumulated normal impulse stays positive
+    Float3x4 normal{load(wide.normal)};
+    float4   lambda{ml::simd::mul(load(wide.normalMass), ml::simd::sub(load(wide.velocityBias), dot(relativeVelocity(), normal)))};
+    float4   accumulated{ml::simd::max(ml::simd::add(normalImpulse, lambda), ml::simd::zero())};
+    lambda = ml::simd::sub(accumulated, normalImpulse);
+    applyImpulse(normal * lambda);
+
+    store(wide.normalImpulse, accumulated);
+    store(wide.tangentImpulse1, tangentImpulse1);
+    store(wide.tangentImpulse2, tangentImpulse2);
+    scatter(bodies.linearVelocities, wide.bodyA, wide.writeA, body.linearA);
+    scatter(bodies.angularVelocities, wide.bodyA, wide.writeA, body.angularA);
+    scatter(bodies.linearVelocities, wide.bodyB, wide.writeB, body.linearB);
+    scatter(bodies.angularVelocities, wide.bodyB, wide.writeB, body.angularB);
+  }
+}
+
+void ContactSolver::storeImpulses(std::span<const WideConstraint> constraints) {
+  for (const WideConstraint &wide : constraints) {
+    for (std::size_t lane{0}; lane < SIMD_LANES && wide.point[lane] != nullptr; ++lane) {
+      ContactPoint &point{*wide.point[lane]};
+      point.normalImpulse   = wide.normalImpulse[lane];
+      point.tangentImpulse1 = wide.tangentImpulse1[lane];
+      point.tangentImpulse2 = wide.tangentImpulse2[lane];
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "BodyStorage.hpp"
+#include "CollisionInfo.hpp"
+#include "Jobs/IJobScheduler.hpp"
+
+#include "Maths/Math.hpp"
+#include "Library.hpp"
+
+// Sequential impulses solver.
+// Every contact keeps the sum of the impulses applied on it: the sum is clamped instead of each impulse so a later
+// iteration can take back an overshoot, and the sums are written back in the ContactPoint to warm start the next step.
+// The islands don't share any dynamic body, they are solved in parallel. The constraints of the big islands are colored
+// instead so that no two constraints of a color touch the same dynamic body, every color is then solved in parallel.
+// With SSE, the constraints of a color are also packed by 4 in structure of arrays batches solved by 128 bits kernels.
+// Based on "Iterative Dynamics with Temporal Coherence" by Erin Catto : https://box2d.org/files/ErinCatto_IterativeDynamics_GDC2005.pdf
+class ContactSolver final {
+public:
+  static constexpr std::size_t DEFAULT_ITERATIONS{8};
+  static constexpr float       BAUMGARTE{0.2f};               // fraction of the penetration fixed by each step
+  static constexpr float       PENETRATION_SLOP{0.01f};       // penetration left alone, so resting contacts stay touching
+  static constexpr float       RESTITUTION_THRESHOLD{1.0f};   // slower approaching speeds don't bounce
+  static constexpr float       WARM_START_MIN_COSINE{0.95f};  // the cached impulses are dropped when the normal turned more than that
+  static constexpr std::size_t ISLAND_GRAIN{8};                // islands solved by a single job
+  static constexpr std::size_t COLORING_THRESHOLD{64};         // islands with at least that many constraints are colored
+  static constexpr std::size_t MAX_COLORS{64};                 // one bit per color in a body mask, the constraints left are solved serially
+  static constexpr std::size_t COLOR_GRAIN{32};                // constraints of a color solved by a single job
+  static constexpr std::size_t SIMD_LANES{4};                  // constraints in a batch of the SSE kernels
+
+  DLLATTRIB explicit ContactSolver() = default;
+
+  DLLATTRIB void               setIterations(std::size_t iterations);  // throw std::invalid_argument on 0
+  [[nodiscard]] DLLATTRIB auto getIterations() const noexcept -> std::size_t;
+
+  // relativeA / relativeB: contact point relative to the center of mass of each body, in world space.
+  // A body without angular response (rigid, capsule) only receives the linear part of the impulses.
+  DLLATTRIB void add(std::size_t bodyA, std::size_t bodyB, ContactPoint &point, const ml::vec3 &relativeA, const ml::vec3 &relativeB, bool angularA, bool angularB, std::size_t island);
+  // Apply the cached impulses, iterate, store the new ones and clear the contacts. The rigid bodies are never written to.
+  // scratch holds the temporary arrays of the step
+  DLLATTRIB void solve(BodyStorage &bodies, float dt, IJobScheduler &scheduler, std::pmr::memory_resource &scratch);
+  DLLATTRIB void clear() noexcept;
+
+  // Copy the accumulated impulses of a previous contact of the same pair when their normals agree
+  DLLATTRIB static void warmStartFrom(const ContactPoint &previous, ContactPoint &current) noexcept;
+  // Same for every point of a manifold, matched with the previous points by feature id
+  DLLATTRIB static void warmStartFrom(const CollisionInfo &previous, CollisionInfo &current) noexcept;
+
+private:
+  class Constraint final {
+  public:
+    std::size_t         bodyA{0};
+    std::size_t         bodyB{0};
+    std::size_t         island{0};
+    std::size_t         color{0};
+    ContactPoint *      point{nullptr};
+    ml::vec3            relativeA{0.0f, 0.0f, 0.0f};
+    ml::vec3            relativeB{0.0f, 0.0f, 0.0f};
+    bool                angularA{true};
+    bool                angularB{true};
+    bool                rigidA{false};
+    bool                rigidB{false};
+    ml::vec3            normal{0.0f, 0.0f, 0.0f};  // from A to B
+    ml::vec3            tangent1{0.0f, 0.0f, 0.0f};
+    ml::vec3            tangent2{0.0f, 0.0f, 0.0f};
+    float               inverseMassA{0.0f};
+    float               inverseMassB{0.0f};
+    Matrix<float, 3, 3> inverseInertiaA{};  // null when the body has no angular response or is rigid
+    Matrix<float, 3, 3> inverseInertiaB{};
+    float               normalMass{0.0f};
+    float               tangentMass1{0.0f};
+    float               tangentMass2{0.0f};
+    float               velocityBias{0.0f};  // separating speed targeted by the normal impulse
+    float               friction{0.0f};
+    float               normalImpulse{0.0f};
+    float               tangentImpulse1{0.0f};
+    float               tangentImpulse2{0.0f};
+  };
+
+#if ML_SIMD_SSE
+  // SIMD_LANES constraints of a color, one lane each. The lanes past the last constraint have null masses and write nothing
+  class WideConstraint final {
+  public:
+    using Lanes = std::array<float, SIMD_LANES>;
+
+    std::array<std::size_t, SIMD_LANES>     bodyA{};
+    std::array<std::size_t, SIMD_LANES>     bodyB{};
+    std::array<bool, SIMD_LANES>            writeA{};  // false for a rigid body and for an unused lane
+    std::array<bool, SIMD_LANES>            writeB{};
+    std::array<ContactPoint *, SIMD_LANES>  point{};
+    std::array<Lanes, 3>                    relativeA{};  // x, y and z of every lane
+    std::array<Lanes, 3>                    relativeB{};
+    std::array<Lanes, 3>                    normal{};
+    std::array<Lanes, 3>                    tangent1{};
+    std::array<Lanes, 3>                    tangent2{};
+    Lanes                                   inverseMassA{};
+    Lanes                                   inverseMassB{};
+    std::array<Lanes, 9>                    inverseInertiaA{};  // column major
+    std::array<Lanes, 9>                    inverseInertiaB{};
+    Lanes                                   normalMass{};
+    Lanes                                   tangentMass1{};
+    Lanes                                   tangentMass2{};
+    Lanes                                   velocityBias{};
+    Lanes                                   friction{};
+    Lanes                                   normalImpulse{};
+    Lanes                                   tangentImpulse1{};
+    Lanes                                   tangentImpulse2{};
+  };
+#endif
+
+  void sortByIsland(std::pmr::memory_resource &scratch);
+  void colorBigIslands(const BodyStorage &bodies, std::pmr::memory_resource &scratch);  // fill m_coloredConstraints, m_smallIslands gets the others
+  void solveColors(BodyStorage &bodies, float dt, IJobScheduler &scheduler);
+
+  // the steps below work on the constraints of a range
+  void        solveRange(BodyStorage &bodies, float dt, std::span<Constraint> constraints);
+  static void prepare(const BodyStorage &bodies, float dt, std::span<Constraint> constraints);
+  static void warmStart(BodyStorage &bodies, std::span<const Constraint> constraints);
+  static void solveVelocities(BodyStorage &bodies, std::span<Constraint> constraints);
+  static void storeImpulses(std::span<const Constraint> constraints);
+  static void computeMasses(std::span<Constraint> constraints);
+
+#if ML_SIMD_SSE
+  void        packColors(IJobScheduler &scheduler);  // m_coloredConstraints -> m_wideConstraints, without the overflow
+  static void pack(WideConstraint &wide, std::span<const Constraint> constraints);
+  static void computeMasses(WideConstraint &wide);
+  static void warmStart(BodyStorage &bodies, std::span<const WideConstraint> constraints);
+  static void solveVelocities(BodyStorage &bodies, std::span<WideConstraint> constraints);
+  static void storeImpulses(std::span<const WideConstraint> constraints);
+#endif
+
+  [[nodiscard]] static auto effectiveMass(const Constraint &constraint, const ml::vec3 &direction) -> float;
+  [[nodiscard]] static auto relativeVelocity(const BodyStorage &bodies, const Constraint &constraint) -> ml::vec3;
+  static void               applyImpulse(BodyStorage &bodies, const Constraint &constraint, const ml::vec3 &impulse);
+
+  std::vector<Constraint>    m_constraints{};
+  std::vector<Constraint>    m_sortedConstraints{};
+  std::vector<std::size_t>   m_islandOffsets{};  // constraints of the island i are [m_islandOffsets[i], m_islandOffsets[i + 1])
+  std::vector<std::size_t>   m_smallIslands{};   // islands solved by a single job
+  std::vector<Constraint>    m_coloredConstraints{};
+  std::vector<std::size_t>   m_colorOffsets{};   // same as m_islandOffsets for the colors, the last one is the overflow
+  std::vector<std::uint64_t> m_bodyColors{};     // colors already used by each body
+#if ML_SIMD_SSE
+  std::vector<WideConstraint> m_wideConstraints{};
+  std::vector<std::size_t>    m_wideColorOffsets{};  // batches of the color i are [m_wideColorOffsets[i], m_wideColorOffsets[i + 1])
+#endif
+  std::size_t                m_iterations{DEFAULT_ITERATIONS};
+};
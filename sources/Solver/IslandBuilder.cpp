@@ -0,0 +1,73 @@
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include "IslandBuilder.hpp"
+
+void IslandBuilder::reset(std::size_t bodyCount) {
+  m_parents.resize(bodyCount);
+  std::iota(m_parents.begin(), m_parents.end(), std::size_t{0});
+  m_sizes.assign(bodyCount, 1);
+}
+
+auto IslandBuilder::find(std::size_t body) noexcept -> std::size_t {
+  while (m_parents[body] != body) {
+    m_parents[body] = m_parents[m_parents[body]];
+    body            = m_parents[body];
+  }
+  return body;
+}
+
+void IslandBuilder::link(std::size_t first, std::size_t second) {
+  std::size_t rootFirst{find(first)};
+  std::size_t rootSecond{find(second)};
+  if (rootFirst == rootSecond)
+    return;
+  if (m_sizes[rootFirst] < m_sizes[rootSecond])
+    std::swap(rootFirst, rootSecond);
+  m_parents[rootSecond] = rootFirst;
+  m_sizes[rootFirst] += m_sizes[rootSecond];
+}
+
+void IslandBuilder::build(const BodyStorage &bodies, std::pmr::memory_resource &scratch) {
+  std::size_t bodyCount{m_parents.size()};
+
+  // number the roots, then count the bodies of every island
+  m_islandOf.assign(bodyCount, NO_ISLAND);
+  std::pmr::vector<std::size_t> rootIsland(bodyCount, NO_ISLAND, &scratch);
+  m_islandOffsets.assign(1, 0);
+  for (std::size_t i{0}; i < bodyCount; ++i) {
+    if (bodies.rigids[i])
+      continue;
+    std::size_t root{find(i)};
+    if (rootIsland[root] == NO_ISLAND) {
+      rootIsland[root] = m_islandOffsets.size() - 1;
+      m_islandOffsets.push_back(0);
+    }
+    m_islandOf[i] = rootIsland[root];
+    ++m_islandOffsets[m_islandOf[i] + 1];
+  }
+  std::partial_sum(m_islandOffsets.begin(), m_islandOffsets.end(), m_islandOffsets.begin());
+
+  // counting sort of the bodies by island
+  m_bodies.resize(m_islandOffsets.back());
+  std::pmr::vector<std::size_t> cursors(m_islandOffsets.begin(), m_islandOffsets.end() - 1, &scratch);
+  for (std::size_t i{0}; i < bodyCount; ++i) {
+    if (m_islandOf[i] != NO_ISLAND)
+      m_bodies[cursors[m_islandOf[i]]++] = i;
+  }
+}
+
+auto IslandBuilder::getIslandCount() const noexcept -> std::size_t {
+  return m_islandOffsets.empty() ? 0 : m_islandOffsets.size() - 1;
+}
+
+auto IslandBuilder::getIsland(std::size_t island) const -> std::span<const std::size_t> {
+  if (island >= getIslandCount())
+    throw std::out_of_range{"invalid island " + std::to_string(island)};
+  return std::span<const std::size_t>{m_bodies}.subspan(m_islandOffsets[island], m_islandOffsets[island + 1] - m_islandOffsets[island]);
+}
+
+auto IslandBuilder::getIslandOf(std::size_t body) const noexcept -> std::size_t {
+  return m_islandOf[body];
+}
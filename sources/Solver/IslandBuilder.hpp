@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "BodyStorage.hpp"
+
+#include "Library.hpp"
+
+// Groups the bodies linked by contacts in islands with a union-find (union by size, path halving).
+// Rigid bodies are never part of an island and don't link the bodies touching them:
+// two boxes resting on the same floor are two islands which can fall asleep independently.
+// Islands are rebuilt from scratch every step, indices are dense body indices.
+class IslandBuilder final {
+public:
+  static constexpr std::size_t NO_ISLAND{SIZE_MAX};
+
+  DLLATTRIB explicit IslandBuilder() = default;
+
+  DLLATTRIB void reset(std::size_t bodyCount);
+  DLLATTRIB void link(std::size_t first, std::size_t second);
+  DLLATTRIB void build(const BodyStorage &bodies, std::pmr::memory_resource &scratch);  // Sort the dynamic bodies by island, call once every link is done
+
+  [[nodiscard]] DLLATTRIB auto getIslandCount() const noexcept -> std::size_t;
+  [[nodiscard]] DLLATTRIB auto getIsland(std::size_t island) const -> std::span<const std::size_t>;  // dense indices of the bodies of an island
+  [[nodiscard]] DLLATTRIB auto getIslandOf(std::size_t body) const noexcept -> std::size_t;          // NO_ISLAND for a rigid body
+
+private:
+  [[nodiscard]] auto find(std::size_t body) noexcept -> std::size_t;
+
+  std::vector<std::size_t> m_parents{};
+  std::vector<std::size_t> m_sizes{};
+  std::vector<std::size_t> m_islandOf{};       // body -> island
+  std::vector<std::size_t> m_bodies{};         // bodies sorted by island
+  std::vector<std::size_t> m_islandOffsets{};  // island i is m_bodies[m_islandOffsets[i], m_islandOffsets[i + 1])
+};
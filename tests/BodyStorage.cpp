@@ -0,0 +1,58 @@
+#include <stdexcept>
+
+#include "Check.hpp"
+
+#include "PhysicsSystem.hpp"
+
+namespace {
+  [[nodiscard]] auto makeSphere() -> PhysicsObject {
+    return PhysicsObject{CollisionShape{Sphere{ml::vec3{0.0f, 0.0f, 0.0f}, 0.5f}}};
+  }
+
+  [[nodiscard]] bool throwsInvalidArgument(PhysicsSystem &system, const Transform &transform) {
+    try {
+      (void)system.createBody(makeSphere(), transform);
+    } catch (const std::invalid_argument &) {
+      return true;
+    }
+    return false;
+  }
+}
+
+TEST(scaledTransformIsKept) {
+  PhysicsSystem system{};
+  Transform     transform{};
+  transform.matrix[0][0] = -2.0f;  // half a turn around y, scaled by 2 along x
+  transform.matrix[2][2] = -1.0f;
+  transform.matrix.setTranslation(ml::vec3{1.0f, 2.0f, 3.0f});
+  BodyHandle handle{system.createBody(makeSphere(), transform)};
+
+  bool isSame{true};
+  for (std::size_t column{0}; column < 4; ++column) {
+    for (std::size_t row{0}; row < 4; ++row)
+      isSame = isSame && tests::near(system.getTransform(handle).matrix[column][row], transform.matrix[column][row]);
+  }
+  CHECK(isSame);
+}
+
+TEST(degenerateTransformsAreRejected) {
+  PhysicsSystem system{};
+  Transform     flat{};
+  flat.matrix[1][1] = 0.0f;
+  CHECK(throwsInvalidArgument(system, flat));
+
+  Transform mirrored{};
+  mirrored.matrix[0][0] = -1.0f;
+  CHECK(throwsInvalidArgument(system, mirrored));
+  CHECK(system.getBodies().size() == 0);
+
+  BodyHandle handle{system.createBody(makeSphere())};
+  bool       isRejected{false};
+  try {
+    system.setTransform(handle, flat);
+  } catch (const std::invalid_argument &) {
+    isRejected = true;
+  }
+  CHECK(isRejected);
+  CHECK(system.getTransform(handle).matrix[1][1] == 1.0f);
+}
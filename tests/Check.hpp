@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Minimal test harness without dependency: TEST registers a function run by main, CHECK reports and counts the failures
+namespace tests {
+  class TestCase final {
+  public:
+    const char *name{nullptr};
+    void (*run)(){nullptr};
+  };
+
+  inline auto registry() -> std::vector<TestCase> & {
+    static std::vector<TestCase> cases{};
+    return cases;
+  }
+
+  inline int failures{0};
+
+  class Registrar final {
+  public:
+    Registrar(const char *name, void (*run)()) {
+      registry().push_back(TestCase{name, run});
+    }
+  };
+
+  [[nodiscard]] inline bool near(float a, float b, float tolerance = 1.0e-3f) {
+    return std::fabs(a - b) <= tolerance;
+  }
+}
+
+#define TEST(name)                                           \
+  static void             name();                            \
+  static tests::Registrar name##Registrar{#name, &name};     \
+  static void             name()
+
+#define CHECK(condition)                                                                  \
+  do {                                                                                    \
+    if (!(condition)) {                                                                   \
+      ++tests::failures;                                                                  \
+      std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);          \
+    }                                                                                     \
+  } while (false)
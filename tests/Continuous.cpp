@@ -0,0 +1,40 @@
+#include <utility>
+
+#include "Check.hpp"
+
+#include "PhysicsSystem.hpp"
+
+namespace {
+  constexpr float DT{1.0f / 60.0f};
+
+  // position of a continuous sphere of radius 0.1 after one step at velocity, from position
+  auto stepContinuous(const ml::vec3 &position, const ml::vec3 &velocity) -> ml::vec3 {
+    PhysicsSystem system{};
+    PhysicsObject floor{CollisionShape{AABB{ml::vec3{-5.0f, -1.0f, -5.0f}, ml::vec3{5.0f, 0.0f, 5.0f}}}};
+    floor.setIsRigid(true);
+    floor.setInverseMass(0.0f);
+    (void)system.createBody(std::move(floor));
+
+    PhysicsObject ball{CollisionShape{Sphere{ml::vec3{0.0f, 0.0f, 0.0f}, 0.1f}}};
+    ball.setIsContinuous(true);
+    Transform transform{};
+    transform.matrix.setTranslation(position);
+    BodyHandle handle{system.createBody(std::move(ball), transform)};
+    system.setLinearVelocity(handle, velocity);
+    system.update(DT, 0);
+    return system.getTransform(handle).matrix.getTranslation();
+  }
+}
+
+TEST(continuousBodyStopsOnTheFloor) {
+  ml::vec3 position{stepContinuous(ml::vec3{0.0f, 1.0f, 0.0f}, ml::vec3{0.0f, -120.0f, 0.0f})};
+  CHECK(position.y > 0.0f && position.y < 0.2f);
+}
+
+TEST(continuousBodySlidesAlongTheFloor) {
+  // 0.001 above the floor, inside the tolerance of the sweep, moving by twice its radius
+  ml::vec3 sliding{stepContinuous(ml::vec3{0.0f, 0.101f, 0.0f}, ml::vec3{12.0f, 0.0f, 0.0f})};
+  CHECK(tests::near(sliding.x, 0.2f));
+  ml::vec3 leaving{stepContinuous(ml::vec3{0.0f, 0.101f, 0.0f}, ml::vec3{0.0f, 12.0f, 0.0f})};
+  CHECK(tests::near(leaving.y, 0.301f));
+}
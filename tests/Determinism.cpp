@@ -0,0 +1,58 @@
+#include <utility>
+
+#include "Check.hpp"
+
+#include "PhysicsSystem.hpp"
+
+namespace {
+  class Run final {
+  public:
+    std::vector<std::pair<int, int>> contacts{};  // new contacts in the order of the callback
+    std::vector<ml::mat4>            transforms{};
+  };
+
+  // a few hundred boxes and spheres falling on a floor, enough to split every stage in several jobs
+  auto simulate(std::size_t workerCount) -> Run {
+    Run           run{};
+    PhysicsSystem system{};
+    system.setWorkerCount(workerCount);
+    system.setCallbackCollision([&run](int first, int second) { run.contacts.emplace_back(first, second); });
+
+    PhysicsObject floor{CollisionShape{AABB{ml::vec3{-20.0f, -1.0f, -20.0f}, ml::vec3{20.0f, 0.0f, 20.0f}}}};
+    floor.setIsRigid(true);
+    floor.setInverseMass(0.0f);
+    (void)system.createBody(std::move(floor));
+
+    std::vector<BodyHandle> handles{};
+    for (int i{0}; i < 300; ++i) {
+      Transform transform{};
+      transform.matrix.setTranslation(ml::vec3{static_cast<float>(i % 10) * 1.1f - 5.0f, 1.0f + static_cast<float>(i / 100) * 1.1f, static_cast<float>(i / 10 % 10) * 1.1f - 5.0f});
+      PhysicsObject body{i % 2 == 0 ? CollisionShape{OBB{ml::vec3{-0.5f, -0.5f, -0.5f}, ml::vec3{0.5f, 0.5f, 0.5f}}} : CollisionShape{Sphere{ml::vec3{0.0f, 0.0f, 0.0f}, 0.5f}}};
+      handles.push_back(system.createBody(std::move(body), transform));
+    }
+
+    for (int step{0}; step < 60; ++step) {
+      for (BodyHandle handle : handles)
+        system.addForce(handle, ml::vec3{0.0f, -9.81f, 0.0f}, false);
+      system.update(1.0f / 60.0f, 0);
+    }
+    for (BodyHandle handle : handles)
+      run.transforms.push_back(system.getTransform(handle).matrix);
+    return run;
+  }
+}
+
+TEST(sameResultsForAnyWorkerCount) {
+  Run single{simulate(1)};
+  Run parallel{simulate(4)};
+  CHECK(!single.contacts.empty());
+  CHECK(single.contacts == parallel.contacts);
+  CHECK(single.transforms.size() == parallel.transforms.size());
+  bool isSame{true};
+  for (std::size_t i{0}; i < single.transforms.size() && i < parallel.transforms.size(); ++i)
+    for (std::size_t column{0}; column < 4; ++column) {
+      for (std::size_t row{0}; row < 4; ++row)
+        isSame = isSame && single.transforms[i][column][row] == parallel.transforms[i][column][row];
+    }
+  CHECK(isSame);  // bit for bit
+}
@@ -0,0 +1,98 @@
+#include "Check.hpp"
+
+#include "Narrowphase/BoxBox.hpp"
+#include "Narrowphase/Gjk.hpp"
+
+namespace {
+  const Box UNIT_BOX{Box::fromBounds(Bounds{ml::vec3{-1.0f, -1.0f, -1.0f}, ml::vec3{1.0f, 1.0f, 1.0f}})};
+
+  [[nodiscard]] bool isNormal(const ContactPoint &point, float x, float y, float z) {
+    return tests::near(point.normal.x, x) && tests::near(point.normal.y, y) && tests::near(point.normal.z, z);
+  }
+
+  [[nodiscard]] bool isOrthogonal(const ContactPoint &point, const ml::vec3 &axis) {
+    return tests::near(point.normal.length(), 1.0f) && tests::near(point.normal.dot(axis), 0.0f);
+  }
+}
+
+TEST(sphereOnBox) {
+  Segment       core{ml::vec3{0.0f, 1.3f, 0.0f}, ml::vec3{0.0f, 1.3f, 0.0f}};
+  CollisionInfo info{};
+  CHECK(collideConvex(ConvexShape{UNIT_BOX}, ConvexShape{core, 0.5f}, info));
+  CHECK(info.pointCount == 1);
+  CHECK(isNormal(info.points[0], 0.0f, 1.0f, 0.0f));
+  CHECK(tests::near(info.points[0].penetration, 0.2f));
+
+  CollisionInfo apart{};
+  Segment       above{ml::vec3{0.0f, 1.6f, 0.0f}, ml::vec3{0.0f, 1.6f, 0.0f}};
+  CHECK(!collideConvex(ConvexShape{UNIT_BOX}, ConvexShape{above, 0.5f}, apart));
+}
+
+TEST(sphereCenterInsideBox) {
+  // the cores overlap, EPA gives the way out
+  Segment       core{ml::vec3{0.0f, 0.8f, 0.0f}, ml::vec3{0.0f, 0.8f, 0.0f}};
+  CollisionInfo info{};
+  CHECK(collideConvex(ConvexShape{UNIT_BOX}, ConvexShape{core, 0.5f}, info));
+  CHECK(isNormal(info.points[0], 0.0f, 1.0f, 0.0f));
+  CHECK(tests::near(info.points[0].penetration, 0.7f));
+}
+
+TEST(capsuleOnBox) {
+  Segment       core{ml::vec3{-0.5f, 1.4f, 0.0f}, ml::vec3{0.5f, 1.4f, 0.0f}};
+  CollisionInfo info{};
+  CHECK(collideConvex(ConvexShape{UNIT_BOX}, ConvexShape{core, 0.5f}, info));
+  CHECK(isNormal(info.points[0], 0.0f, 1.0f, 0.0f));
+  CHECK(tests::near(info.points[0].penetration, 0.1f));
+}
+
+TEST(flatOverlaps) {
+  // the Minkowski difference of the cores has no volume, EPA can't run
+  Segment       alongX{ml::vec3{-1.0f, 0.0f, 0.0f}, ml::vec3{1.0f, 0.0f, 0.0f}};
+  Segment       diagonal{ml::vec3{-1.0f, 0.0f, -1.0f}, ml::vec3{1.0f, 0.0f, 1.0f}};
+  CollisionInfo crossing{};
+  CHECK(collideConvex(ConvexShape{alongX, 0.5f}, ConvexShape{diagonal, 0.5f}, crossing));
+  CHECK(isOrthogonal(crossing.points[0], ml::vec3{1.0f, 0.0f, 0.0f}) && isOrthogonal(crossing.points[0], ml::vec3{0.0f, 0.0f, 1.0f}));
+  CHECK(tests::near(crossing.points[0].penetration, 1.0f));
+
+  Segment       onAxis{ml::vec3{0.3f, 0.0f, 0.0f}, ml::vec3{0.3f, 0.0f, 0.0f}};
+  CollisionInfo sphereOnAxis{};
+  CHECK(collideConvex(ConvexShape{alongX, 0.5f}, ConvexShape{onAxis, 0.5f}, sphereOnAxis));
+  CHECK(isOrthogonal(sphereOnAxis.points[0], ml::vec3{1.0f, 0.0f, 0.0f}));
+  CHECK(tests::near(sphereOnAxis.points[0].penetration, 1.0f));
+
+  Segment       center{ml::vec3{1.0f, 2.0f, 3.0f}, ml::vec3{1.0f, 2.0f, 3.0f}};
+  CollisionInfo concentric{};
+  CHECK(collideConvex(ConvexShape{center, 0.5f}, ConvexShape{center, 0.25f}, concentric));
+  CHECK(tests::near(concentric.points[0].normal.length(), 1.0f));
+  CHECK(tests::near(concentric.points[0].penetration, 0.75f));
+}
+
+TEST(castHitsTheBoxItMovesTo) {
+  Segment    core{ml::vec3{0.0f, 3.0f, 0.0f}, ml::vec3{0.0f, 3.0f, 0.0f}};
+  ConvexCast cast{};
+  CHECK(castConvex(ConvexShape{core, 0.5f}, ml::vec3{0.0f, -4.0f, 0.0f}, ConvexShape{UNIT_BOX}, 1.0e-3f, 1.0f, cast));
+  CHECK(tests::near(cast.fraction, 0.375f));
+  CHECK(tests::near(cast.normal.y, 1.0f));
+  CHECK(!cast.isOverlapping);
+}
+
+TEST(castGrazingABoxMissesIt) {
+  // 0.5 above a wide box, swept along it
+  Box        floor{Box::fromBounds(Bounds{ml::vec3{-100.0f, -1.0f, -100.0f}, ml::vec3{100.0f, 0.0f, 100.0f}})};
+  Segment    core{ml::vec3{0.0f, 1.0f, 0.0f}, ml::vec3{0.0f, 1.0f, 0.0f}};
+  ConvexCast cast{};
+  CHECK(!castConvex(ConvexShape{core, 0.5f}, ml::vec3{100.0f, 0.0f, 0.0f}, ConvexShape{floor}, 1.0e-3f, 1.0f, cast));
+}
+
+TEST(castTouchingWhileMovingAwayMisses) {
+  Box     floor{Box::fromBounds(Bounds{ml::vec3{-100.0f, -1.0f, -100.0f}, ml::vec3{100.0f, 0.0f, 100.0f}})};
+  Segment core{ml::vec3{-0.5f, 0.5f, 0.0f}, ml::vec3{0.5f, 0.5f, 0.0f}};  // a capsule lying on the floor
+
+  ConvexCast sideways{};
+  CHECK(!castConvex(ConvexShape{core, 0.5f}, ml::vec3{5.0f, 0.0f, 0.0f}, ConvexShape{floor}, 1.0e-3f, 1.0f, sideways));
+  ConvexCast away{};
+  CHECK(!castConvex(ConvexShape{core, 0.5f}, ml::vec3{1.0f, 2.0f, 0.0f}, ConvexShape{floor}, 1.0e-3f, 1.0f, away));
+  ConvexCast into{};
+  CHECK(castConvex(ConvexShape{core, 0.5f}, ml::vec3{1.0f, -2.0f, 0.0f}, ConvexShape{floor}, 1.0e-3f, 1.0f, into));
+  CHECK(tests::near(into.fraction, 0.0f));
+}
@@ -0,0 +1,56 @@
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "Check.hpp"
+
+#include "PhysicsSystem.hpp"
+
+TEST(rayHitsAScaledBox) {
+  PhysicsSystem system{};
+  Transform     transform{};
+  transform.matrix[0][0] = 2.0f;
+  transform.matrix[1][1] = 3.0f;
+  transform.matrix[2][2] = 4.0f;
+  transform.matrix.setTranslation(ml::vec3{10.0f, 0.0f, 0.0f});
+  BodyHandle handle{system.createBody(PhysicsObject{CollisionShape{OBB{ml::vec3{-1.0f, -1.0f, -1.0f}, ml::vec3{1.0f, 1.0f, 1.0f}}}}, transform)};
+
+  RayCollision collision{};
+  CHECK(system.RayIntersection(Ray{ml::vec3{0.0f, 2.5f, 3.5f}, ml::vec3{1.0f, 0.0f, 0.0f}}, collision));
+  CHECK(collision.node == handle);
+  CHECK(tests::near(collision.rayDistance, 8.0f));
+  CHECK(tests::near(collision.collidedAt.x, 8.0f) && tests::near(collision.collidedAt.y, 2.5f) && tests::near(collision.collidedAt.z, 3.5f));
+
+  RayCollision outside{};
+  CHECK(!system.RayIntersection(Ray{ml::vec3{0.0f, 3.5f, 0.0f}, ml::vec3{1.0f, 0.0f, 0.0f}}, outside));
+}
+
+TEST(parallelBatchMatchesSingleRays) {
+  PhysicsSystem system{};
+  system.setWorkerCount(4);
+  for (int i{0}; i < 64; ++i) {
+    Transform transform{};
+    transform.matrix.setTranslation(ml::vec3{static_cast<float>(i % 8) * 3.0f - 12.0f, 0.0f, static_cast<float>(i / 8) * 3.0f - 12.0f});
+    (void)system.createBody(PhysicsObject{CollisionShape{Capsule{ml::vec3{0.0f, 1.0f, 0.0f}, ml::vec3{0.0f, -1.0f, 0.0f}, 0.5f}}}, transform);
+  }
+
+  std::vector<Ray> rays{};
+  for (int i{0}; i < 1024; ++i) {
+    ml::vec3 direction{std::cos(static_cast<float>(i) * 0.1f), std::sin(static_cast<float>(i) * 0.37f) * 0.2f, std::sin(static_cast<float>(i) * 0.1f)};
+    direction.normalize();
+    rays.emplace_back(ml::vec3{0.1f, 0.0f, 0.2f} * static_cast<float>(i % 7), direction);
+  }
+  std::vector<RayCollision> results(rays.size());
+  system.RayIntersection(rays, results, RaycastOptions{true, true, false});
+
+  bool isSame{true};
+  int  hits{0};
+  for (std::size_t i{0}; i < rays.size(); ++i) {
+    RayCollision single{};
+    bool         isHit{system.RayIntersection(rays[i], single)};
+    hits += isHit ? 1 : 0;
+    isSame = isSame && results[i].node == single.node && results[i].rayDistance == single.rayDistance;
+  }
+  CHECK(hits > 0);
+  CHECK(isSame);
+}
@@ -0,0 +1,10 @@
+#include "Check.hpp"
+
+int main() {
+  for (const tests::TestCase &test : tests::registry()) {
+    int failures{tests::failures};
+    test.run();
+    std::printf("%s %s\n", failures == tests::failures ? "PASS" : "FAIL", test.name);
+  }
+  return tests::failures == 0 ? 0 : 1;
+}